@@ -0,0 +1,346 @@
+// Banc de mesure time2d : un cas par étage du pipeline, seeds fixes.
+//
+//   g++ -std=c++20 -O2 -pthread bench_time2d.cpp randomGenPolyShape.cpp -o bench_time2d
+//   bench_time2d [--filter txt] [--min-time s] [--out base.json] [--baseline base.json] [--threshold pct] [--list]
+//
+// Par cas : ns/op (médiane de 5 répétitions), allocations et octets par op (operator new global),
+// éléments/s. --out écrit un JSON de référence ; --baseline compare à une référence et renvoie 1
+// si un cas est plus lent de plus de --threshold % (10 par défaut) ou alloue davantage.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "randomGenPolyShape.hpp"
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+#include "time2d_w2.h"
+#include "time2d_macros.h"
+#include "time2d_pipeline.h"
+
+// -----------------------------
+// Comptage des allocations (operator new global ; les variantes alignées ne sont pas comptées)
+// -----------------------------
+static std::atomic<uint64_t> g_allocs{ 0 }, g_alloc_bytes{ 0 };
+
+static void* counted_alloc(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n) { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { try { return counted_alloc(n); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { try { return counted_alloc(n); } catch (...) { return nullptr; } }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// -----------------------------
+// Mesure
+// -----------------------------
+static volatile uint64_t g_sink = 0;   // empêche l’élimination des résultats
+
+struct BenchCase {
+    std::string name;
+    std::function<uint64_t()> op;      // une opération ; renvoie le nombre d’éléments traités
+};
+
+struct BenchResult {
+    std::string name;
+    double ns_per_op{ 0 }, allocs_per_op{ 0 }, bytes_per_op{ 0 }, items_per_sec{ 0 };
+    uint64_t iterations{ 0 };
+};
+
+static BenchResult run_case(const BenchCase& c, double min_time) {
+    using clock = std::chrono::steady_clock;
+    constexpr int kReps = 5;
+
+    uint64_t items = c.op();           // échauffement (caches, pool, capacités)
+
+    // calibrage : nombre d’itérations pour ~min_time / kReps par répétition
+    uint64_t iters = 1;
+    for (;;) {
+        const auto t0 = clock::now();
+        for (uint64_t i = 0; i < iters; ++i) g_sink = g_sink + c.op();
+        const double s = std::chrono::duration<double>(clock::now() - t0).count();
+        if (s >= min_time / kReps || iters >= (1ull << 30)) break;
+        iters = (s <= 0.0) ? iters * 16 : std::max(iters * 2, (uint64_t)((min_time / kReps) / s * (double)iters * 1.2));
+    }
+
+    std::vector<double> ns(kReps);
+    const uint64_t a0 = g_allocs.load(), b0 = g_alloc_bytes.load();
+    for (int r = 0; r < kReps; ++r) {
+        const auto t0 = clock::now();
+        for (uint64_t i = 0; i < iters; ++i) { items = c.op(); g_sink = g_sink + items; }
+        ns[r] = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / (double)iters;
+    }
+    const double ops = (double)iters * kReps;
+
+    BenchResult res;
+    res.name = c.name;
+    std::nth_element(ns.begin(), ns.begin() + kReps / 2, ns.end());
+    res.ns_per_op = ns[kReps / 2];
+    res.allocs_per_op = (double)(g_allocs.load() - a0) / ops;
+    res.bytes_per_op = (double)(g_alloc_bytes.load() - b0) / ops;
+    res.items_per_sec = (res.ns_per_op > 0) ? (double)items * 1e9 / res.ns_per_op : 0.0;
+    res.iterations = iters * kReps;
+    return res;
+}
+
+// -----------------------------
+// Cas (seeds fixes, paramètres de metatime)
+// -----------------------------
+static t2dgen::RandomGenPolyShape::Params shape_params(int r) {
+    t2dgen::RandomGenPolyShape::Params p;
+    p.base_size = 1.0; p.child_scale = 0.25; p.min_sides = 3; p.max_sides = 8;
+    p.fixed_iterations = r;
+    p.seed = 0xC0FFEEULL;
+    return p;
+}
+
+static t2d::Shape make_shape(int r) {
+    t2dgen::RandomGenPolyShape gen(shape_params(r));
+    return gen.generate();
+}
+
+static t2d::M2Params m2_params(int N, int k) {
+    t2d::M2Params m;
+    m.replicas_k = (k > 0) ? std::min(k, std::max(1, N - 1)) : std::min(std::max(1, N / 20), std::max(1, N - 1));
+    m.thunder_span = 24; m.thunder_jitter = 0.8; m.replica_rate = 0.6; m.magmat_span = 60;
+    m.seed = 0xBADC0DEULL;
+    return m;
+}
+
+static t2d::I2Params i2_params(int N, int r) {
+    t2d::I2Params ip;
+    ip.total_vertices_n = N; ip.iterations_inherited = r;
+    ip.force_rate = 0.05; ip.life_mean = 10.0; ip.life_jitter = 0.20; ip.sample_max = 10;
+    ip.seed = 0x1BADB002ULL;
+    return ip;
+}
+
+static t2d::LatencyTargets targets_for(const t2d::I2Plan& i2, int retention) {
+    t2d::LatencyTargets t;
+    t.target_lost_exact = std::max(0, i2.grains_lost / retention);
+    t.target_mem_min = std::max(0, i2.grains_total - t.target_lost_exact);
+    t.f_lo = 0.10; t.f_hi = 10.0; t.max_iter = 40;
+    return t;
+}
+
+static std::vector<BenchCase> make_cases() {
+    using namespace t2d;
+    std::vector<BenchCase> cases;
+
+    // ---------- forme ----------
+    for (int r = 1; r <= 4; ++r) {
+        cases.push_back({ "shape/generate/r=" + std::to_string(r), [r] {
+            t2dgen::RandomGenPolyShape gen(shape_params(r));
+            return (uint64_t)gen.generate().V.size();
+            } });
+    }
+    {
+        auto out = std::make_shared<Shape>();
+        cases.push_back({ "shape/generate_into/r=4", [out] {
+            t2dgen::RandomGenPolyShape gen(shape_params(4));
+            gen.generate_into(*out);
+            return (uint64_t)out->V.size();
+            } });
+    }
+
+    // ---------- M2 (forme r=4 fixe, k variable) ----------
+    auto shape4 = std::make_shared<const Shape>(make_shape(4));
+    const int N4 = (int)shape4->V.size();
+    for (int k : { 1, 16, 256, 0 }) {
+        const M2Params mp = m2_params(N4, k);
+        cases.push_back({ "m2/generate/k=" + (k ? std::to_string(k) : std::string("N/20")), [shape4, mp] {
+            return (uint64_t)generate_m2(*shape4, mp).event_count();
+            } });
+    }
+
+    // ---------- I2 (N variable) ----------
+    auto m2_4 = std::make_shared<const M2Plan>(generate_m2(*shape4, m2_params(N4, 0)));
+    for (int N : { 1000, 100000, 1000000 }) {
+        const I2Params ip = i2_params(N, 4);
+        cases.push_back({ "i2/generate/N=" + std::to_string(N), [m2_4, ip] {
+            return (uint64_t)generate_i2(*m2_4, ip).grains_total;
+            } });
+        cases.push_back({ "i2/count/N=" + std::to_string(N), [m2_4, ip] {
+            const I2Counts c = count_i2(*m2_4, ip);
+            return (uint64_t)(c.grains_memorized + c.grains_lost);
+            } });
+    }
+
+    // ---------- macros ----------
+    {
+        const I2Params ip = i2_params(N4, 4);
+        auto i2 = std::make_shared<const I2Plan>(generate_i2(*m2_4, ip));
+        const LatencyTargets tgt = targets_for(*i2, 4);
+        W2Params w2p; w2p.subdivision_level = 3; w2p.offset_step = 0.15;
+        auto w2 = std::make_shared<const W2Plan>(generate_w2_structure(*i2, w2p));
+        W2MacroControls w2c;
+        w2c.PROCESS_EXISTENCE_TIME = 2; w2c.PROCESS_SUPPORT_TIME = 1; w2c.ENVIRONNMENT_CORPSE_TIME = 0.5;
+
+        W2Params w2p64 = w2p; w2p64.subdivision_level = kW2MaxSlots; w2p64.support_time = 1.0; w2p64.corpse_time = 0.5;
+        cases.push_back({ "w2/structure/level=64", [i2, w2p64] {
+            const W2Plan w = generate_w2_structure(*i2, w2p64);
+            g_sink = g_sink + (uint64_t)w.slots[w.slots.size() - 1].subdivision;
+            return (uint64_t)w.slots.size();
+            } });
+        cases.push_back({ "macros/core", [m2_4, i2, ip, tgt] {
+            const Macros mx = compute_macros(*i2, ip, *m2_4, tgt, MacroParams{});
+            g_sink = g_sink + (uint64_t)mx.CONTAINER_RANGE_TIME;
+            return (uint64_t)1;
+            } });
+        cases.push_back({ "macros/w2", [m2_4, i2, w2, ip, tgt, w2c] {
+            const Macros mx = compute_macros(*i2, ip, *m2_4, *w2, w2c, tgt, MacroParams{});
+            g_sink = g_sink + (uint64_t)mx.W2_ACTIVE;
+            return (uint64_t)1;
+            } });
+    }
+
+    // ---------- pipeline complet (équivalent metatime, sans saisie ni cache I2) ----------
+    {
+        auto pipe = std::make_shared<Pipeline>();
+        pipe->set_shape_params(shape_params(4));
+        pipe->set_m2_params(m2_params(0, 0));
+        I2Params ip = i2_params(0, 1);
+        pipe->set_i2_params(ip);
+        LatencyTargets t; t.f_lo = 0.10; t.f_hi = 10.0; t.max_iter = 40;
+        pipe->set_targets(t);
+        pipe->set_replicas_divisor(20);
+        pipe->set_retention_factor(4);
+        W2Params w2p; w2p.subdivision_level = 3; w2p.offset_step = 0.15;
+        pipe->set_w2_params(w2p);
+        W2MacroControls w2c;
+        w2c.PROCESS_EXISTENCE_TIME = 2; w2c.PROCESS_SUPPORT_TIME = 1; w2c.ENVIRONNMENT_CORPSE_TIME = 0.5;
+        pipe->set_w2_controls(w2c);
+
+        cases.push_back({ "pipeline/metatime/r=4", [pipe] {
+            pipe->invalidate(Pipeline::StageAll);
+            const Macros& mx = pipe->macros();
+            // projection (facteur high), comme metatime
+            I2Params pr = pipe->i2_params_effective();
+            pr.life_mean = std::max(1e-9, pr.life_mean * mx.MEMORY_LATENCY_TIME_FACTOR_high);
+            const I2Plan proj = generate_i2(pipe->m2(), pr);
+            g_sink = g_sink + (uint64_t)proj.grains_memorized;
+            return (uint64_t)pipe->shape().V.size();
+            } });
+    }
+    return cases;
+}
+
+// -----------------------------
+// Référence JSON
+// -----------------------------
+static void write_json(const std::string& path, const std::vector<BenchResult>& res) {
+    std::ofstream f(path, std::ios::binary);
+    f << std::setprecision(9);
+    f << "{\n  \"version\": 1,\n  \"results\": [\n";
+    for (size_t i = 0; i < res.size(); ++i) {
+        const BenchResult& r = res[i];
+        f << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.ns_per_op
+            << ", \"allocs_per_op\": " << r.allocs_per_op << ", \"bytes_per_op\": " << r.bytes_per_op
+            << ", \"items_per_sec\": " << r.items_per_sec << "}" << (i + 1 < res.size() ? ",\n" : "\n");
+    }
+    f << "  ]\n}\n";
+}
+
+// lecture minimale du format écrit par write_json (un résultat par ligne)
+static std::vector<BenchResult> read_json(const std::string& path) {
+    std::vector<BenchResult> out;
+    std::ifstream f(path, std::ios::binary);
+    std::string line;
+    auto num = [](const std::string& l, const char* key) {
+        const size_t p = l.find(key);
+        return (p == std::string::npos) ? 0.0 : std::strtod(l.c_str() + p + std::strlen(key), nullptr);
+    };
+    while (std::getline(f, line)) {
+        const size_t p = line.find("\"name\": \"");
+        if (p == std::string::npos) continue;
+        const size_t b = p + 9, e = line.find('"', b);
+        BenchResult r;
+        r.name = line.substr(b, e - b);
+        r.ns_per_op = num(line, "\"ns_per_op\": ");
+        r.allocs_per_op = num(line, "\"allocs_per_op\": ");
+        r.bytes_per_op = num(line, "\"bytes_per_op\": ");
+        r.items_per_sec = num(line, "\"items_per_sec\": ");
+        out.push_back(r);
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    std::string filter, out_path, base_path;
+    double min_time = 0.5, threshold_pct = 10.0;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view a = argv[i];
+        auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+        if (a == "--filter") filter = next();
+        else if (a == "--min-time") min_time = std::max(0.01, std::atof(next()));
+        else if (a == "--out") out_path = next();
+        else if (a == "--baseline") base_path = next();
+        else if (a == "--threshold") threshold_pct = std::max(0.0, std::atof(next()));
+        else if (a == "--list") list = true;
+        else { std::cerr << "option inconnue: " << a << "\n"; return 2; }
+    }
+
+    const std::vector<BenchCase> cases = make_cases();
+    if (list) { for (const auto& c : cases) std::cout << c.name << "\n"; return 0; }
+
+    std::vector<BenchResult> base;
+    if (!base_path.empty()) {
+        base = read_json(base_path);
+        if (base.empty()) { std::cerr << "reference vide ou illisible: " << base_path << "\n"; return 2; }
+    }
+
+    std::cout << std::left << std::setw(28) << "cas" << std::right
+        << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op" << std::setw(14) << "octets/op"
+        << std::setw(14) << "elements/s" << (base.empty() ? "" : "   vs ref") << "\n";
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    for (const BenchCase& c : cases) {
+        if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+        const BenchResult r = run_case(c, min_time);
+        results.push_back(r);
+
+        std::cout << std::left << std::setw(28) << r.name << std::right << std::fixed
+            << std::setw(14) << std::setprecision(0) << r.ns_per_op
+            << std::setw(12) << std::setprecision(1) << r.allocs_per_op
+            << std::setw(14) << std::setprecision(0) << r.bytes_per_op
+            << std::setw(14) << std::scientific << std::setprecision(3) << r.items_per_sec << std::fixed;
+        const auto it = std::find_if(base.begin(), base.end(), [&](const BenchResult& b) { return b.name == r.name; });
+        if (it != base.end() && it->ns_per_op > 0) {
+            const double delta = 100.0 * (r.ns_per_op / it->ns_per_op - 1.0);
+            const bool slow = delta > threshold_pct;
+            const bool alloc = r.allocs_per_op > it->allocs_per_op + 0.5;
+            regressions += slow || alloc;
+            std::cout << "   " << std::showpos << std::setprecision(1) << delta << "%" << std::noshowpos
+                << (slow ? "  REGRESSION" : "") << (alloc ? "  ALLOCS" : "");
+        }
+        else if (!base.empty()) std::cout << "   (nouveau)";
+        std::cout << std::endl;
+    }
+
+    if (!out_path.empty()) write_json(out_path, results);
+    if (!base.empty()) {
+        std::cout << "\n" << regressions << " regression(s) (seuil " << threshold_pct << " %)\n";
+        return regressions ? 1 : 0;
+    }
+    return 0;
+}
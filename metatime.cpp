@@ -1,14 +1,28 @@
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <random>
 #include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
 
 #include "RandomGenPolyShape.hpp"
 #include "time2d_m2.h"
 #include "time2d_i2.h"
+#include "time2d_i2_cache.h"
 #include "time2d_w2.h"
 #include "time2d_macros.h"
+#include "time2d_pool.h"
 #include "time2d_interface.h"  // UI = t2d::iface::{Inputs,W2Inputs}+sanitize
+#include "time2d_perf.h"       // compteurs par étage (-DT2D_ENABLE_PERF_COUNTERS)
 
 // --- utils ---
 static uint64_t make_seed() {
@@ -17,34 +31,566 @@ static uint64_t make_seed() {
     return a ? a : 0xA5A5A5A5ULL;
 }
 static t2d::I2Plan simulate_with_factor(const t2d::M2Plan& m2, const t2d::I2Params& base, double f) {
-    t2d::I2Params p = base;
-    p.life_mean = std::max(1e-9, base.life_mean * f);
-    return t2d::generate_i2(m2, p);
+    return *t2d::I2Cache::shared().simulate(m2, base, f);   // memoïsé (même résultat que generate_i2)
 }
 
-int main() {
+// ==========================
+// Calcul d’un scénario (partagé par le mode interactif et le mode batch)
+// ==========================
+
+// PHASES 1..3 : forme, foudre, terre+glace
+struct Front {
+    t2dgen::RandomGenPolyShape::Params genP;
+    t2d::Shape    shape;
+    int           r{ 0 }, N{ 0 };
+    t2d::M2Params m2;
+    t2d::M2Plan   plan_m2;
+    t2d::I2Params ip;
+    t2d::I2Plan   plan_i2;
+};
+
+static Front run_front(uint64_t seed_shape, uint64_t seed_m2, uint64_t seed_i2) {
     using namespace t2d;
     using namespace t2dgen;
+    Front F;
+
+    F.genP.base_size = 1.0;
+    F.genP.child_scale = 0.25;
+    F.genP.min_sides = 3;
+    F.genP.max_sides = 8;
+    F.genP.seed = seed_shape;
+
+    RandomGenPolyShape gen(F.genP);
+    gen.generate_into(F.shape);
+    F.r = gen.iterations();
+    F.N = gen.totalVertices();
+
+    F.m2.replicas_k = std::min(std::max(1, F.N / 20), std::max(1, F.N - 1));
+    F.m2.thunder_span = 24;
+    F.m2.thunder_jitter = 0.8;
+    F.m2.replica_rate = 0.6;
+    F.m2.magmat_span = 60;
+    F.m2.seed = seed_m2;
+    F.plan_m2 = generate_m2(F.shape, F.m2);
+
+    F.ip.total_vertices_n = F.N;
+    F.ip.iterations_inherited = F.r;
+    F.ip.force_rate = 0.05;
+    F.ip.life_mean = 10.0;
+    F.ip.life_jitter = 0.20;
+    F.ip.sample_max = 10;
+    F.ip.seed = seed_i2;
+    F.plan_i2 = generate_i2(F.plan_m2, F.ip);
+    return F;
+}
+
+// CIBLES “glace” + PHASE 5 (W2 structure + macros) + projection
+struct Back {
+    int lost_now{ 0 }, Ntot{ 0 };
+    int target_lost_exact{ 0 }, lost_remainder{ 0 }, target_mem_min{ 0 };
+    t2d::LatencyTargets  targets;
+    t2d::MacroParams     mparams;  // edge_share=0.20
+    t2d::W2Params        w2p;
+    t2d::W2Plan          w2;
+    t2d::W2MacroControls w2c;
+    t2d::Macros          MX;
+    t2d::I2Plan          proj;
+};
+
+static Back run_back(const Front& F, const t2d::iface::Inputs& ui, const t2d::iface::W2Inputs& uiw2) {
+    Back B;
+    B.lost_now = F.plan_i2.grains_lost;
+    B.Ntot = F.plan_i2.grains_total;
+    B.target_lost_exact = std::max(0, B.lost_now / ui.TIME_RETENTION_FACTOR);
+    B.lost_remainder = B.lost_now - B.target_lost_exact * ui.TIME_RETENTION_FACTOR;
+    B.target_mem_min = std::max(0, B.Ntot - B.target_lost_exact);
+
+    B.targets.target_mem_min = B.target_mem_min;
+    B.targets.target_lost_exact = B.target_lost_exact;
+    B.targets.f_lo = 0.10; B.targets.f_hi = 10.0; B.targets.max_iter = 40;
+
+    B.w2p.subdivision_level = uiw2.subdivision_level;
+    B.w2p.offset_step = uiw2.offset_step;
+    B.w2p.support_time = uiw2.PROCESS_SUPPORT_TIME;       // vies des empreintes (une passe)
+    B.w2p.corpse_time = uiw2.ENVIRONNMENT_CORPSE_TIME;
+    B.w2 = t2d::generate_w2_structure(F.plan_i2, B.w2p);
+
+    B.w2c.PROCESS_EXISTENCE_TIME = uiw2.PROCESS_EXISTENCE_TIME;
+    B.w2c.PROCESS_SUPPORT_TIME = uiw2.PROCESS_SUPPORT_TIME;
+    B.w2c.ENVIRONNMENT_CORPSE_TIME = uiw2.ENVIRONNMENT_CORPSE_TIME;
+    B.w2c.ENVIRONNMENT_RECOVER_TIME = uiw2.ENVIRONNMENT_RECOVER_TIME;
+
+    // Macros avec surcharge W2
+    B.MX = t2d::compute_macros(F.plan_i2, F.ip, F.plan_m2, B.w2, B.w2c, B.targets, B.mparams);
+
+    // Projection (contrôle) avec facteur "high"
+    B.proj = simulate_with_factor(F.plan_m2, F.ip, B.MX.MEMORY_LATENCY_TIME_FACTOR_high);
+    return B;
+}
+
+// CIBLE DE REBONDS R (tolérance 8%) : ajuste ui / uiw2 et calcule la lisibilité
+struct Readout {
+    double center_share{ 0.0 };
+    int    readable_capacity{ 0 }, readable_center{ 0 }, readable_effective{ 0 };
+};
+
+static Readout apply_rebounds(const Back& B, int R, t2d::iface::Inputs& ui, t2d::iface::W2Inputs& uiw2) {
+    // ====== UNITÉS ======
+    constexpr double TICK_SEC = 0.01;                       // 1 tick = 10 ms
+    const double service_time_s = B.proj.service_time * TICK_SEC;
+
+    // --- STRUCTURE W2 : capacité >= R
+    uiw2.subdivision_level = std::max(1, R + 1);
+    uiw2.PROCESS_EXISTENCE_TIME = (double)R;   // cible
+    uiw2.PROCESS_SUPPORT_TIME = (double)R;   // actives = R (borné par cible)
+
+    // --- offset_step : pure géométrie (pas d'effet lisibilité) -> conserver la saisie précédente
+    // uiw2.offset_step = uiw2.offset_step;
+
+    // --- BOIS : échelle lisible (facultatif), en secondes
+    uiw2.ENVIRONNMENT_CORPSE_TIME = std::max(0.0, 2.0 * service_time_s);
+
+    // --- RELECTURE (fenêtre temps) : READ pour viser R avec +8%
+    const double edge_share = B.mparams.edge_share;         // 0.20 par défaut
+    const double center_share = 1.0 - edge_share;           // 0.80
+    const double eps = 0.08;                       // 8%
+    const double READ_needed = (R <= 0)
+        ? 0.0
+        : ((double)R * B.proj.service_time / center_share) * (1.0 + eps);
+
+    ui.CONTAINER_TIME_READ = std::max(0.0, READ_needed);    // en ticks (coeur I2/M2)
+
+    Readout O;
+    O.center_share = center_share;
+    O.readable_capacity = (int)std::floor(ui.CONTAINER_TIME_READ / std::max(1e-12, B.proj.service_time));
+    O.readable_center = (int)std::floor(O.readable_capacity * center_share);
+    O.readable_effective = std::min(B.proj.grains_memorized, O.readable_center);
+    return O;
+}
+
+// ==========================
+// Mode batch : metatime --batch <scenarios.jsonl|.csv> <sortie.jsonl|.csv> [--threads n]
+// ==========================
+// Un scénario = seeds (0 ou absent => aléatoire, la valeur utilisée est reportée), Inputs, W2Inputs, R.
+// Clés (JSONL : un objet plat par ligne ; CSV : ligne d’en-tête, cellules vides = défaut) :
+//   id, seed_shape, seed_m2, seed_i2 (décimal ou "0x..."), TIME_RETENTION_FACTOR, CONTAINER_TIME_READ,
+//   subdivision_level, offset_step, PROCESS_EXISTENCE_TIME, PROCESS_SUPPORT_TIME,
+//   ENVIRONNMENT_CORPSE_TIME, ENVIRONNMENT_RECOVER_TIME, R
+// Sortie : un enregistrement par scénario, dans l’ordre du fichier ("error" non vide si ligne invalide).
+struct Scenario {
+    std::string id;
+    uint64_t seed_shape{ 0 }, seed_m2{ 0 }, seed_i2{ 0 };
+    t2d::iface::Inputs   ui;
+    t2d::iface::W2Inputs uiw2;
+    int R{ 5 };
+    std::string error;
+};
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+template <class T>
+static bool parse_num(std::string_view v, T& out) {
+    const char* b = v.data(); const char* e = b + v.size();
+    if constexpr (std::is_integral_v<T>) {
+        int base = 10;
+        if (v.size() > 2 && v[0] == '0' && (v[1] == 'x' || v[1] == 'X')) { b += 2; base = 16; }
+        auto [p, ec] = std::from_chars(b, e, out, base);
+        return ec == std::errc() && p == e;
+    }
+    else {
+        auto [p, ec] = std::from_chars(b, e, out);
+        return ec == std::errc() && p == e;
+    }
+}
+
+// clés acceptées par set_field
+static constexpr std::string_view kScenarioKeys[] = {
+    "id", "seed_shape", "seed_m2", "seed_i2", "TIME_RETENTION_FACTOR", "CONTAINER_TIME_READ",
+    "subdivision_level", "offset_step", "PROCESS_EXISTENCE_TIME", "PROCESS_SUPPORT_TIME",
+    "ENVIRONNMENT_CORPSE_TIME", "ENVIRONNMENT_RECOVER_TIME", "R"
+};
+static bool known_key(std::string_view key) {
+    return std::find(std::begin(kScenarioKeys), std::end(kScenarioKeys), key) != std::end(kScenarioKeys);
+}
+
+static bool set_field(Scenario& s, std::string_view key, std::string_view v) {
+    if (key == "id") { s.id.assign(v); return true; }
+    if (key == "seed_shape") return parse_num(v, s.seed_shape);
+    if (key == "seed_m2") return parse_num(v, s.seed_m2);
+    if (key == "seed_i2") return parse_num(v, s.seed_i2);
+    if (key == "TIME_RETENTION_FACTOR") return parse_num(v, s.ui.TIME_RETENTION_FACTOR);
+    if (key == "CONTAINER_TIME_READ") return parse_num(v, s.ui.CONTAINER_TIME_READ);
+    if (key == "subdivision_level") return parse_num(v, s.uiw2.subdivision_level);
+    if (key == "offset_step") return parse_num(v, s.uiw2.offset_step);
+    if (key == "PROCESS_EXISTENCE_TIME") return parse_num(v, s.uiw2.PROCESS_EXISTENCE_TIME);
+    if (key == "PROCESS_SUPPORT_TIME") return parse_num(v, s.uiw2.PROCESS_SUPPORT_TIME);
+    if (key == "ENVIRONNMENT_CORPSE_TIME") return parse_num(v, s.uiw2.ENVIRONNMENT_CORPSE_TIME);
+    if (key == "ENVIRONNMENT_RECOVER_TIME") return parse_num(v, s.uiw2.ENVIRONNMENT_RECOVER_TIME);
+    if (key == "R") return parse_num(v, s.R);
+    return false;
+}
+
+// chaîne JSON commençant à line[i] == '"' ; échappements simples décodés (\uXXXX refusé).
+// En sortie, i pointe après le guillemet fermant.
+static bool read_json_string(std::string_view line, size_t& i, std::string& out, std::string& err) {
+    out.clear();
+    for (++i; i < line.size(); ++i) {
+        const char ch = line[i];
+        if (ch == '"') { ++i; return true; }
+        if (ch != '\\') { out += ch; continue; }
+        if (++i >= line.size()) break;
+        switch (line[i]) {
+        case '"':  out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/':  out += '/'; break;
+        case 'b':  out += '\b'; break;
+        case 'f':  out += '\f'; break;
+        case 'n':  out += '\n'; break;
+        case 'r':  out += '\r'; break;
+        case 't':  out += '\t'; break;
+        case 'u':  err = "JSON: échappement \\u non supporté"; return false;
+        default:   err = "JSON: échappement invalide"; return false;
+        }
+    }
+    err = "JSON: chaîne non terminée";
+    return false;
+}
+
+// objet JSON plat : "cle": valeur (nombre ou chaîne), séparés par des virgules ; pas d’objet ni de tableau imbriqué
+static Scenario parse_jsonl_line(std::string_view line) {
+    Scenario s;
+    std::string key, val;
+    size_t i = 0;
+    auto ws = [&] { while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i; };
+    auto at = [&](char c) { return i < line.size() && line[i] == c; };
+    auto fail = [&](std::string msg) { s.error = std::move(msg); return s; };
+
+    ws();
+    if (!at('{')) return fail("objet JSON attendu");
+    ++i; ws();
+    if (at('}')) ++i;
+    else for (;;) {
+        ws();
+        if (!at('"')) return fail("JSON invalide: clé attendue");
+        if (!read_json_string(line, i, key, s.error)) return s;
+        ws();
+        if (!at(':')) return fail("JSON invalide: ':' attendu");
+        ++i; ws();
+        if (at('"')) { if (!read_json_string(line, i, val, s.error)) return s; }
+        else if (at('{') || at('[')) return fail("JSON: valeur imbriquée non supportée: " + key);
+        else {
+            const size_t v0 = i;
+            while (i < line.size() && line[i] != ',' && line[i] != '}' && line[i] != ' ' && line[i] != '\t') ++i;
+            val.assign(line.substr(v0, i - v0));
+        }
+        if (!set_field(s, key, val)) return fail("champ invalide: " + key);
+        ws();
+        if (at(',')) { ++i; continue; }
+        if (at('}')) { ++i; break; }
+        return fail("JSON invalide: ',' ou '}' attendu");
+    }
+    ws();
+    if (i != line.size()) return fail("JSON invalide: contenu après l’objet");
+    return s;
+}
+
+// enregistrement CSV (RFC 4180) : cellule entre guillemets ("" = guillemet ; virgules et fins de ligne
+// permises) ; blancs autour des cellules ignorés hors guillemets. `open` : guillemet non refermé en fin
+// de texte (l’enregistrement continue sur la ligne suivante)
+static bool split_csv(std::string_view line, std::vector<std::string>& out, std::string& err, bool& open) {
+    out.clear();
+    open = false;
+    size_t i = 0;
+    for (;;) {
+        std::string cell;
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+        if (i < line.size() && line[i] == '"') {
+            for (++i;; ++i) {
+                if (i >= line.size()) { err = "CSV: cellule entre guillemets non terminée"; open = true; return false; }
+                if (line[i] != '"') { cell += line[i]; continue; }
+                if (i + 1 < line.size() && line[i + 1] == '"') { cell += '"'; ++i; continue; }
+                ++i;
+                break;
+            }
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+            if (i < line.size() && line[i] != ',') { err = "CSV: texte après une cellule entre guillemets"; return false; }
+        }
+        else {
+            const size_t e = std::min(line.find(',', i), line.size());
+            const std::string_view raw = trim(line.substr(i, e - i));
+            if (raw.find('"') != std::string_view::npos) { err = "CSV: guillemet dans une cellule sans guillemets"; return false; }
+            cell.assign(raw);
+            i = e;
+        }
+        out.push_back(std::move(cell));
+        if (i >= line.size()) return true;
+        ++i;   // ','
+    }
+}
+
+static bool ends_with_csv(const std::string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+}
+
+static bool read_scenarios(const std::string& path, std::vector<Scenario>& out, std::string& err) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { err = "lecture impossible: " + path; return false; }
+
+    const bool csv = ends_with_csv(path);
+    std::vector<std::string> header, cells;
+    std::string line, more;
+    while (std::getline(in, line)) {
+        std::string_view l = trim(line);
+        if (l.empty() || l[0] == '#') continue;
+        if (!csv) { out.push_back(parse_jsonl_line(l)); continue; }
+
+        // cellule entre guillemets ouverte en fin de ligne : l’enregistrement continue
+        Scenario s;
+        bool open = false, parsed = split_csv(l, cells, s.error, open);
+        if (!parsed && open) {
+            std::string rec(l);
+            while (!parsed && open && std::getline(in, more)) {
+                if (!more.empty() && more.back() == '\r') more.pop_back();
+                rec += '\n';
+                rec += more;
+                s.error.clear();
+                parsed = split_csv(rec, cells, s.error, open);
+            }
+        }
+        if (!parsed) {
+            if (header.empty()) { err = "en-tête: " + s.error; return false; }
+            out.push_back(std::move(s));
+            continue;
+        }
+        if (header.empty()) {   // noms validés une fois : une colonne mal nommée n’est jamais ignorée
+            for (const std::string& h : cells)
+                if (!known_key(h)) { err = "en-tête: colonne inconnue: " + h; return false; }
+            header = cells;
+            continue;
+        }
+        for (size_t c = 0; s.error.empty() && c < std::min(cells.size(), header.size()); ++c)
+            if (!cells[c].empty() && !set_field(s, header[c], cells[c])) s.error = "champ invalide: " + header[c];
+        if (s.error.empty() && cells.size() != header.size()) s.error = "nombre de colonnes";
+        out.push_back(std::move(s));
+    }
+    return true;
+}
+
+// enregistrement de sortie : valeurs déjà formatées, dans l’ordre de kRecordColumns
+static constexpr const char* kRecordColumns[] = {
+    "id", "seed_shape", "seed_m2", "seed_i2", "r", "N", "E", "replicas_k", "thunder_min_gap", "thunder_tau",
+    "grains_memorized", "grains_lost", "rate_memorized", "mean_finish_time", "target_lost_exact", "target_mem_min",
+    "MEMORY_SPREAD_TIME_CONSTRAINT_pct", "MEMORY_LATENCY_TIME_FACTOR_low", "MEMORY_LATENCY_TIME_FACTOR_high",
+    "CONTAINER_RANGE_TIME", "CONTAINER_FLOW_TIME", "proj_memorized", "proj_lost", "proj_service_time",
+    "CONTAINER_TIME_READ", "readable_capacity", "readable_effective", "w2_rebounds_capacity",
+    "W2_REBOUNDS_TARGET", "W2_ACTIVE", "W2_DISAPPEARED",
+#if defined(T2D_ENABLE_PERF_COUNTERS)
+    "perf_shape_ns", "perf_m2_ns", "perf_i2_ns", "perf_macros_ns", "perf_i2_simulations",
+    "perf_macros_i2_simulations", "perf_bisection_iterations", "perf_events", "perf_grains", "perf_bytes",
+#endif
+    "error"
+};
+static constexpr size_t kRecordFields = sizeof(kRecordColumns) / sizeof(kRecordColumns[0]);
+
+struct Record {
+    std::string v[kRecordFields];
+    size_t n{ 0 };
+
+    void add(std::string s) { v[n++] = std::move(s); }
+    void add(double x) {   // non fini (inf / nan) : cellule vide en CSV, null en JSONL
+        if (!std::isfinite(x)) { add(std::string()); return; }
+        char b[32]; add(std::string(b, std::to_chars(b, b + 32, x).ptr));
+    }
+    void add(int x) { char b[16]; add(std::string(b, std::to_chars(b, b + 16, x).ptr)); }
+    void add_u64(uint64_t x) { char b[24]; add(std::string(b, std::to_chars(b, b + 24, x).ptr)); }
+    void add_hex(uint64_t x) { char b[24] = "0x"; add(std::string(b, std::to_chars(b + 2, b + 24, x, 16).ptr)); }
+    bool failed() const { return !v[kRecordFields - 1].empty(); }
+};
+
+static Record run_scenario(Scenario s) {
+    Record rec;
+    rec.add(s.id);
+    if (!s.error.empty()) { rec.v[kRecordFields - 1] = s.error; return rec; }
+
+    if (!s.seed_shape) s.seed_shape = make_seed();
+    if (!s.seed_m2) s.seed_m2 = make_seed();
+    if (!s.seed_i2) s.seed_i2 = make_seed();
+    t2d::iface::Inputs ui = t2d::iface::sanitize(s.ui);
+    t2d::iface::W2Inputs uiw2 = t2d::iface::sanitize(s.uiw2);
+    const int R = std::max(0, s.R);
+
+    T2D_PERF_ONLY(t2d::iface::PerfCounters pc; t2d::perf::Capture cap(pc);)
+    const Front F = run_front(s.seed_shape, s.seed_m2, s.seed_i2);
+    const Back B = run_back(F, ui, uiw2);
+    const Readout O = apply_rebounds(B, R, ui, uiw2);
+
+    rec.add_hex(s.seed_shape);
+    rec.add_hex(s.seed_m2);
+    rec.add_hex(s.seed_i2);
+    rec.add(F.r);
+    rec.add(F.N);
+    rec.add((int)F.shape.E.size());
+    rec.add(F.plan_m2.replicas_effective);
+    rec.add(F.plan_m2.thunder_min_gap);
+    rec.add(F.plan_m2.thunder_tau);
+    rec.add(F.plan_i2.grains_memorized);
+    rec.add(F.plan_i2.grains_lost);
+    rec.add(F.plan_i2.rate_memorized);
+    rec.add(F.plan_i2.mean_finish_time);
+    rec.add(B.target_lost_exact);
+    rec.add(B.target_mem_min);
+    rec.add(B.MX.MEMORY_SPREAD_TIME_CONSTRAINT_pct);
+    rec.add(B.MX.MEMORY_LATENCY_TIME_FACTOR_low);
+    rec.add(B.MX.MEMORY_LATENCY_TIME_FACTOR_high);
+    rec.add(B.MX.CONTAINER_RANGE_TIME);
+    rec.add(B.MX.CONTAINER_FLOW_TIME);
+    rec.add(B.proj.grains_memorized);
+    rec.add(B.proj.grains_lost);
+    rec.add(B.proj.service_time);
+    rec.add(ui.CONTAINER_TIME_READ);
+    rec.add(O.readable_capacity);
+    rec.add(O.readable_effective);
+    rec.add(B.w2.rebounds_capacity);
+    rec.add(B.MX.W2_REBOUNDS_TARGET);
+    rec.add(B.MX.W2_ACTIVE);
+    rec.add(B.MX.W2_DISAPPEARED);
+#if defined(T2D_ENABLE_PERF_COUNTERS)
+    rec.add_u64(pc.shape_ns);
+    rec.add_u64(pc.m2_ns);
+    rec.add_u64(pc.i2_ns);
+    rec.add_u64(pc.macros_ns);
+    rec.add_u64(pc.i2_simulations);
+    rec.add_u64(pc.macros_i2_simulations);
+    rec.add_u64(pc.bisection_iterations);
+    rec.add_u64(pc.events);
+    rec.add_u64(pc.grains);
+    rec.add_u64(pc.shape_bytes + pc.m2_bytes + pc.i2_bytes + pc.macros_bytes);
+#endif
+    return rec;
+}
+
+static void write_header(std::ostream& out) {
+    for (size_t c = 0; c < kRecordFields; ++c) out << (c ? "," : "") << kRecordColumns[c];
+    out << '\n';
+}
+
+// cellule CSV (RFC 4180) : entre guillemets, guillemets doublés, si elle contient , " ou une fin de ligne
+static void write_csv_cell(std::ostream& out, std::string_view v) {
+    if (v.find_first_of(",\"\r\n") == std::string_view::npos) { out << v; return; }
+    out << '"';
+    for (char ch : v) { if (ch == '"') out << '"'; out << ch; }
+    out << '"';
+}
+
+// chaîne JSON : " \ et caractères de contrôle échappés
+static void write_json_string(std::ostream& out, std::string_view v) {
+    out << '"';
+    for (char ch : v) {
+        switch (ch) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if ((unsigned char)ch < 0x20) {
+                static constexpr char hex[] = "0123456789abcdef";
+                out << "\\u00" << hex[(unsigned char)ch >> 4] << hex[(unsigned char)ch & 15];
+            }
+            else out << ch;
+        }
+    }
+    out << '"';
+}
+
+static void write_record(std::ostream& out, const Record& rec, bool csv) {
+    if (csv) {
+        for (size_t c = 0; c < kRecordFields; ++c) { if (c) out << ','; write_csv_cell(out, rec.v[c]); }
+        out << '\n';
+        return;
+    }
+    // JSONL : id / seeds / error en chaînes, le reste en nombres ; champs non calculés omis
+    // (enregistrement en erreur), valeurs non finies écrites null
+    out << '{';
+    bool first = true;
+    for (size_t c = 0; c < kRecordFields; ++c) {
+        const bool str = c <= 3 || c == kRecordFields - 1;
+        if (rec.v[c].empty() && c != 0 && c != kRecordFields - 1 && (str || rec.failed())) continue;
+        out << (first ? "" : ",") << '"' << kRecordColumns[c] << "\":";
+        if (str) write_json_string(out, rec.v[c]);
+        else out << (rec.v[c].empty() ? std::string_view("null") : std::string_view(rec.v[c]));
+        first = false;
+    }
+    out << "}\n";
+}
+
+static int run_batch(const std::string& in_path, const std::string& out_path, unsigned threads) {
+    std::vector<Scenario> scenarios;
+    std::string err;
+    if (!read_scenarios(in_path, scenarios, err)) { std::cerr << "batch: " << err << "\n"; return 1; }
+    std::ofstream out(out_path, std::ios::binary);
+    if (!out) { std::cerr << "batch: ecriture impossible: " << out_path << "\n"; return 1; }
+    const bool csv = ends_with_csv(out_path);
+    if (csv) write_header(out);
+
+    std::unique_ptr<t2d::ThreadPool> own;
+    if (threads) own = std::make_unique<t2d::ThreadPool>(threads);
+    t2d::ThreadPool& pool = own ? *own : t2d::ThreadPool::shared();
+
+    // par vagues : écriture dans l’ordre du fichier sans garder tous les enregistrements
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t wave = 64 * (size_t)pool.size();
+    std::vector<Record> recs;
+    size_t failed = 0;
+    for (size_t b = 0; b < scenarios.size(); b += wave) {
+        const size_t n = std::min(wave, scenarios.size() - b);
+        recs.assign(n, Record{});
+        pool.parallel_for(n, [&](size_t i) { recs[i] = run_scenario(scenarios[b + i]); });
+        for (const Record& r : recs) { write_record(out, r, csv); failed += r.failed(); }
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cerr << "batch: " << scenarios.size() << " scenarios (" << failed << " en erreur) en " << sec
+        << " s, " << (sec > 0 ? (double)scenarios.size() / sec : 0.0) << " scenarios/s sur "
+        << pool.size() << " threads\n";
+    return out ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    using namespace t2d;
+    using namespace t2dgen;
+
+    if (argc >= 2 && std::string_view(argv[1]) == "--batch") {
+        if (argc < 4) {
+            std::cerr << "usage: metatime --batch <scenarios.jsonl|.csv> <sortie.jsonl|.csv> [--threads n]\n";
+            return 2;
+        }
+        unsigned threads = 0;
+        if (argc >= 6 && std::string_view(argv[4]) == "--threads") threads = (unsigned)std::max(0, std::atoi(argv[5]));
+        return run_batch(argv[2], argv[3], threads);
+    }
 
     std::cout << std::fixed << std::setprecision(6);
+    T2D_PERF_ONLY(t2d::iface::PerfCounters pc; t2d::perf::Capture cap(pc);)
+
+    const uint64_t seed_shape = make_seed();
+    const uint64_t seed_m2 = make_seed();
+    const uint64_t seed_i2 = make_seed();
+    const Front F = run_front(seed_shape, seed_m2, seed_i2);
+    const Shape& shape = F.shape;
+    const int r = F.r;
+    const int N = F.N;
+    const M2Plan& plan_m2 = F.plan_m2;
+    const I2Plan& plan_i2 = F.plan_i2;
 
     // =========================
     // PHASE 1 : Génération forme
     // =========================
-    RandomGenPolyShape::Params genP;
-    genP.base_size = 1.0;
-    genP.child_scale = 0.25;
-    genP.min_sides = 3;
-    genP.max_sides = 8;
-    genP.seed = make_seed();
-
-    RandomGenPolyShape gen(genP);
-    Shape shape = gen.generate();
-    const int r = gen.iterations();
-    const int N = gen.totalVertices();
-
     std::cout << "=== PHASE 1 : INIT (forme) ===\n";
-    std::cout << "seed(shape)         = 0x" << std::hex << genP.seed << std::dec << "\n";
+    std::cout << "seed(shape)         = 0x" << std::hex << F.genP.seed << std::dec << "\n";
     std::cout << "Ordre d'iteration r = " << r << "\n";
     std::cout << "Nombre sommets N    = " << N << "\n";
     std::cout << "Segments E          = " << shape.E.size() << "\n\n";
@@ -52,18 +598,8 @@ int main() {
     // ====================
     // PHASE 2 : M2 (foudre)
     // ====================
-    M2Params m2;
-    m2.replicas_k = std::min(std::max(1, N / 20), std::max(1, N - 1));
-    m2.thunder_span = 24;
-    m2.thunder_jitter = 0.8;
-    m2.replica_rate = 0.6;
-    m2.magmat_span = 60;
-    m2.seed = make_seed();
-
-    M2Plan plan_m2 = generate_m2(shape, m2);
-
     std::cout << "=== PHASE 2 : FOUDRE ===\n";
-    std::cout << "seed(thunder)       = 0x" << std::hex << m2.seed << std::dec << "\n";
+    std::cout << "seed(thunder)       = 0x" << std::hex << F.m2.seed << std::dec << "\n";
     std::cout << "Replicas k          = " << plan_m2.replicas_effective << "\n";
     std::cout << "Min gap (reel)      = " << plan_m2.thunder_min_gap << "\n";
     std::cout << "Tau (reel)          = " << plan_m2.thunder_tau << "\n\n";
@@ -78,17 +614,6 @@ int main() {
     // ==========================
     // PHASE 3 : I2 (terre+glace)
     // ==========================
-    I2Params ip;
-    ip.total_vertices_n = N;
-    ip.iterations_inherited = r;
-    ip.force_rate = 0.05;
-    ip.life_mean = 10.0;
-    ip.life_jitter = 0.20;
-    ip.sample_max = 10;
-    ip.seed = make_seed();
-
-    I2Plan plan_i2 = generate_i2(plan_m2, ip);
-
     std::cout << "=== PHASE 3 : I2 (Terre+Glace) ===\n";
     std::cout << "Grains total (N)     = " << plan_i2.grains_total << "\n";
     std::cout << "Passage dimension    = " << plan_i2.passage_dimension << "\n";
@@ -138,44 +663,12 @@ int main() {
     uiw2 = t2d::iface::sanitize(uiw2);
 
     // ==========================
-    // CIBLES “glace” (interface)
-    // ==========================
-    const int lost_now = plan_i2.grains_lost;
-    const int Ntot = plan_i2.grains_total;
-    const int target_lost_exact = std::max(0, lost_now / ui.TIME_RETENTION_FACTOR);
-    const int lost_remainder = lost_now - target_lost_exact * ui.TIME_RETENTION_FACTOR;
-    const int target_mem_min = std::max(0, Ntot - target_lost_exact);
-
-    t2d::LatencyTargets targets;
-    targets.target_mem_min = target_mem_min;
-    targets.target_lost_exact = target_lost_exact;
-    targets.f_lo = 0.10; targets.f_hi = 10.0; targets.max_iter = 40;
-
-    t2d::MacroParams mparams; // edge_share=0.20
-
-    // ==========================
-    // PHASE 5 : W2 structure + macros
+    // CIBLES “glace” + PHASE 5 : W2 structure + macros
     // ==========================
-    t2d::W2Params w2p;
-    w2p.subdivision_level = uiw2.subdivision_level;
-    w2p.offset_step = uiw2.offset_step;
-    t2d::W2Plan w2 = t2d::generate_w2_structure(plan_i2, w2p);
-
-    t2d::W2MacroControls w2c;
-    w2c.PROCESS_EXISTENCE_TIME = uiw2.PROCESS_EXISTENCE_TIME;
-    w2c.PROCESS_SUPPORT_TIME = uiw2.PROCESS_SUPPORT_TIME;
-    w2c.ENVIRONNMENT_CORPSE_TIME = uiw2.ENVIRONNMENT_CORPSE_TIME;
-    w2c.ENVIRONNMENT_RECOVER_TIME = uiw2.ENVIRONNMENT_RECOVER_TIME;
-
-    // Macros avec surcharge W2
-    t2d::Macros MX = t2d::compute_macros(plan_i2, ip, plan_m2, w2, w2c, targets, mparams);
-
-    // Projection (contrôle) avec facteur "high"
-    t2d::I2Plan proj = simulate_with_factor(plan_m2, ip, MX.MEMORY_LATENCY_TIME_FACTOR_high);
-
-    // ====== UNITÉS ======
-    constexpr double TICK_SEC = 0.01;                       // 1 tick = 10 ms
-    const double service_time_s = proj.service_time * TICK_SEC;
+    const Back B = run_back(F, ui, uiw2);
+    const t2d::W2Plan& w2 = B.w2;
+    const t2d::Macros& MX = B.MX;
+    const t2d::I2Plan& proj = B.proj;
 
     // ====== CIBLE DE REBONDS AVEC TOLÉRANCE 8% ======
     int R; // nombre de rebonds souhaité
@@ -183,39 +676,14 @@ int main() {
     if (!(std::cin >> R)) return 0;
     R = std::max(0, R);
 
-    // --- STRUCTURE W2 : capacité >= R
-    uiw2.subdivision_level = std::max(1, R + 1);
-    uiw2.PROCESS_EXISTENCE_TIME = (double)R;   // cible
-    uiw2.PROCESS_SUPPORT_TIME = (double)R;   // actives = R (borné par cible)
-
-    // --- offset_step : pure géométrie (pas d'effet lisibilité) -> conserver la saisie précédente
-    // uiw2.offset_step = uiw2.offset_step;
-
-    // --- BOIS : échelle lisible (facultatif), en secondes
-    uiw2.ENVIRONNMENT_CORPSE_TIME = std::max(0.0, 2.0 * service_time_s);
-
-    // --- RELECTURE (fenêtre temps) : READ pour viser R avec +8%
-    const double edge_share = mparams.edge_share;         // 0.20 par défaut
-    const double center_share = 1.0 - edge_share;           // 0.80
-    const double eps = 0.08;                       // 8%
-    const double READ_needed = (R <= 0)
-        ? 0.0
-        : ((double)R * proj.service_time / center_share) * (1.0 + eps);
-
-    ui.CONTAINER_TIME_READ = std::max(0.0, READ_needed);    // en ticks (coeur I2/M2)
-
-
-    //const double center_share = 1.0 - mparams.edge_share;
-    const int readable_capacity = (int)std::floor(ui.CONTAINER_TIME_READ / std::max(1e-12, proj.service_time));
-    const int readable_center = (int)std::floor(readable_capacity * center_share);
-    const int readable_effective = std::min(proj.grains_memorized, readable_center);
+    const Readout O = apply_rebounds(B, R, ui, uiw2);
 
     // --- Sorties glace
     std::cout << "\n=== CIBLES (glace) ===\n";
-    std::cout << "lost_now=" << lost_now
-        << " -> target_lost=floor(lost/RET)=" << target_lost_exact
-        << " (RET=" << ui.TIME_RETENTION_FACTOR << ", reste=" << lost_remainder << ")\n";
-    std::cout << "target_mem_min = " << target_mem_min << " / N=" << Ntot << "\n";
+    std::cout << "lost_now=" << B.lost_now
+        << " -> target_lost=floor(lost/RET)=" << B.target_lost_exact
+        << " (RET=" << ui.TIME_RETENTION_FACTOR << ", reste=" << B.lost_remainder << ")\n";
+    std::cout << "target_mem_min = " << B.target_mem_min << " / N=" << B.Ntot << "\n";
 
     std::cout << "\n=== MACROS dynamiques ===\n";
     std::cout << "MEMORY_SPREAD_TIME_CONSTRAINT (%) = " << MX.MEMORY_SPREAD_TIME_CONSTRAINT_pct << "\n";
@@ -229,9 +697,9 @@ int main() {
         << "  proj lost=" << proj.grains_lost
         << "  service_time=" << proj.service_time << "\n";
     std::cout << "CONTAINER_TIME_READ=" << ui.CONTAINER_TIME_READ
-        << " -> readable_capacity=" << readable_capacity
-        << " center_share=" << center_share
-        << " readable_effective=" << readable_effective << "\n";
+        << " -> readable_capacity=" << O.readable_capacity
+        << " center_share=" << O.center_share
+        << " readable_effective=" << O.readable_effective << "\n";
 
     // --- W2 récap ---
     std::cout << "\n=== W2 (VENT/BOIS) ===\n";
@@ -251,13 +719,23 @@ int main() {
     std::cout << "\nEmpreintes actives (index, subdiv, offset, life):\n";
     for (int k = 1; k <= MX.W2_ACTIVE && k < (int)w2.slots.size(); ++k) {
         const auto& slot = w2.slots[k];              // k : 1..active
-        const double atten = 1.0 / (1.0 + std::max(0.0, w2c.PROCESS_SUPPORT_TIME) * (double)k);
-        const double life = std::max(0.0, w2c.ENVIRONNMENT_CORPSE_TIME * atten);
         std::cout << "  index=" << slot.index
             << "  subdiv=" << slot.subdivision
             << "  offset=" << slot.offset
-            << "  life=" << life << "\n";
+            << "  life=" << slot.life << "\n";
     }
 
+#if defined(T2D_ENABLE_PERF_COUNTERS)
+    std::cout << "\n=== PERF (cout du calcul) ===\n";
+    std::cout << "temps (ms) : shape=" << pc.shape_ns * 1e-6 << "  m2=" << pc.m2_ns * 1e-6
+        << "  i2=" << pc.i2_ns * 1e-6 << "  macros=" << pc.macros_ns * 1e-6 << "\n";
+    std::cout << "I2 : simulations=" << pc.i2_simulations << " (macros=" << pc.macros_i2_simulations
+        << ")  passes=" << pc.i2_grain_passes << "  dichotomie=" << pc.bisection_iterations
+        << "  quantiles exacts=" << pc.exact_quantiles << "\n";
+    std::cout << "volumes : sommets=" << pc.vertices << "  evenements=" << pc.events << "  grains=" << pc.grains << "\n";
+    std::cout << "octets : shape=" << pc.shape_bytes << "  m2=" << pc.m2_bytes << "  i2=" << pc.i2_bytes
+        << "  macros=" << pc.macros_bytes << "\n";
+#endif
+
     return 0;
 }
@@ -1,9 +1,11 @@
 ﻿#include "RandomGenPolyShape.hpp"
 #include "time2d_m2.h"   // pour t2d::Shape / Vec2 / Segment
+#include "time2d_pool.h"
 
 #include <cmath>
 #include <numeric>
 #include <algorithm>
+#include <memory>
 #include <numbers>                // C++20, inclus HORS namespace
 
 // π (C++20)
@@ -11,11 +13,9 @@ static constexpr double kPI = std::numbers::pi_v<double>;
 
 namespace { // utils privés à ce TU
 
-    struct LCG {
-        std::uint64_t s;
-        explicit LCG(std::uint64_t seed = 0x9e3779b97f4a7c15ULL) : s(seed) {}
-        std::uint32_t next() { s = 2862933555777941757ULL * s + 3037000493ULL; return (std::uint32_t)(s >> 32); }
-        double uniform() { return (next() + 0.5) / 4294967296.0; } // [0,1)
+    // même LCG que t2d::LCG (saut en avant / sous-flux) + tirages propres à la génération de forme
+    struct LCG : t2d::LCG {
+        using t2d::LCG::LCG;
         int    uniformInt(int lo, int hi) { if (hi <= lo) return lo; return lo + (int)std::floor(uniform() * (double)(hi - lo + 1)); }
         double angle() { return uniform() * 2.0 * kPI; }
     };
@@ -30,90 +30,246 @@ namespace t2dgen {
         Params P;
         LCG rng;
 
-        // Représentation interne (indépendante des types t2d::)
-        struct Vec2 { double x{}, y{}; };
-        struct Segment { int a{ -1 }, b{ -1 }; };
+        // Sommets / segments écrits directement dans la t2d::Shape de l’appelant (pas de copie)
+        using Vec2 = t2d::Vec2;
+        using Segment = t2d::Segment;
         struct Poly { int v0{ 0 }, vcount{ 0 }; int e0{ 0 }, ecount{ 0 }; double radius{ 0 }; };
 
-        std::vector<Vec2> V;
-        std::vector<Segment> E;
-        std::vector<int> drawOrder;
+        t2d::Shape* dst{ nullptr };         // sortie de la génération en cours
         std::vector<Poly> polys;
 
         int totalV{ 0 };
         int lastIterations{ 0 };           // <-- mémorise r (1..4) de la dernière génération
 
-        explicit Impl(Params p) : P(p), rng(p.seed) {}
+        // polygones unitaires pré-calculés : sommets (cos, sin)(i * 2π / s) pour s dans [unitLo, unitHi]
+        std::vector<Vec2> unit;
+        std::vector<int>  unitOff;          // unitOff[s - unitLo] = premier sommet du s-gone dans `unit`
+        int unitLo{ 3 }, unitHi{ 2 };
 
-        void reset() { V.clear(); E.clear(); drawOrder.clear(); polys.clear(); totalV = 0; }
+        std::vector<Poly> frontier, next;   // tampons BFS réutilisés (mode séquentiel)
+        std::unique_ptr<t2d::ThreadPool> ownPool;   // si P.threads > 0 (créé à la première utilisation)
 
-        void addRegularPolygon(const Vec2& center, double radius, int sides, double orientRad) {
-            sides = clampi(sides, P.min_sides, P.max_sides);
-            if (sides < 3 || radius <= 0.0) return;
+        explicit Impl(Params p) : P(p), rng(p.seed) { buildUnitTables(); }
 
-            const int v0 = (int)V.size();
-            const int e0 = (int)E.size();
+        // position d’écriture : prochain sommet (= segment, = entrée de draw_order) et prochain polygone
+        struct Cursor { int v{ 0 }, p{ 0 }; };
 
-            const double dtheta = 2.0 * kPI / (double)sides;
+        // côtés effectifs après bornage (mêmes règles que addRegularPolygon)
+        int clampSides(int sides) const { return clampi(sides, P.min_sides, P.max_sides); }
+        bool emits(int sides, double radius) const { return sides >= 3 && radius > 0.0; }
+
+        void buildUnitTables() {
+            unitHi = P.max_sides;
+            unitLo = std::max(3, std::min(P.min_sides, P.max_sides));
+            unit.clear(); unitOff.clear();
+            for (int s = unitLo; s <= unitHi; ++s) {
+                unitOff.push_back((int)unit.size());
+                const double dtheta = 2.0 * kPI / (double)s;
+                for (int i = 0; i < s; ++i) unit.push_back({ std::cos(i * dtheta), std::sin(i * dtheta) });
+            }
+        }
+
+        t2d::ThreadPool& pool() {
+            if (P.threads == 0) return t2d::ThreadPool::shared();
+            if (!ownPool) ownPool = std::make_unique<t2d::ThreadPool>(P.threads);
+            return *ownPool;
+        }
+
+        // Ecrit un polygone régulier aux positions [c.v, c.v + sides) / c.p (tableaux pré-dimensionnés) ;
+        // renvoie false (rien d’écrit) si rejeté. Ecritures disjointes => appelable en parallèle.
+        bool addRegularPolygon(Cursor& c, const Vec2& center, double radius, int sides, double orientRad) {
+            sides = clampSides(sides);
+            if (!emits(sides, radius)) return false;
+
+            Vec2* V = dst->V.data() + c.v;
+            Segment* E = dst->E.data() + c.v;
+            int* drawOrder = dst->draw_order.data() + c.v;
+
+            // une seule rotation par polygone : sommet i = centre + R * rot(orient) * unit[i]
+            const double rc = radius * std::cos(orientRad), rs = radius * std::sin(orientRad);
+            const Vec2* u = unit.data() + unitOff[sides - unitLo];
             for (int i = 0; i < sides; ++i) {
-                double a = orientRad + i * dtheta;
-                V.push_back({ center.x + radius * std::cos(a),
-                              center.y + radius * std::sin(a) });
+                V[i] = { center.x + (u[i].x * rc - u[i].y * rs),
+                         center.y + (u[i].x * rs + u[i].y * rc) };
             }
             for (int i = 0; i < sides; ++i) {
-                int a = v0 + i;
-                int b = v0 + ((i + 1) % sides);
-                E.push_back({ a,b });
-                drawOrder.push_back((int)E.size() - 1);
+                E[i] = { c.v + i, c.v + ((i + 1) % sides) };
+                drawOrder[i] = c.v + i;
+            }
+            polys[(size_t)c.p] = Poly{ c.v, sides, c.v, sides, radius };
+            c.v += sides; ++c.p;
+            return true;
+        }
+
+        // Développe le sous-arbre de `parent` restreint à ses sommets [i0, i1) sur `depths` niveaux (BFS).
+        // Un polygone rejeté duplique le dernier polygone écrit (initialement `parent`) dans la frontière.
+        void expand(LCG& g, const Poly& parent, int i0, int i1, int depths, Cursor& c,
+            std::vector<Poly>& front, std::vector<Poly>& nxt) {
+            Poly last = parent;
+            front.clear();
+            for (int depth = 1; depth <= depths; ++depth) {
+                const bool first = (depth == 1);
+                size_t width = first ? (size_t)(i1 - i0) : 0;
+                if (!first) for (const Poly& pr : front) width += (size_t)pr.vcount;
+                nxt.clear(); nxt.reserve(width);
+                const size_t nparents = first ? 1 : front.size();
+                for (size_t k = 0; k < nparents; ++k) {
+                    const Poly& pr = first ? parent : front[k];
+                    const int b = first ? i0 : 0, e = first ? i1 : pr.vcount;
+                    const double childR = pr.radius * P.child_scale;
+                    for (int i = b; i < e; ++i) {
+                        const Vec2 center = dst->V[(size_t)(pr.v0 + i)];
+                        const int  sides = g.uniformInt(P.min_sides, P.max_sides);
+                        if (addRegularPolygon(c, center, childR, sides, g.angle())) last = polys[(size_t)c.p - 1];
+                        nxt.push_back(last);
+                    }
+                }
+                front.swap(nxt);
+            }
+        }
+
+        // Pré-passe de dimensionnement : rejoue les tirages de expand() (côtés, angle) sur une copie
+        // du générateur et compte exactement sommets / polygones, pour dimensionner V / E / draw_order /
+        // polys une seule fois. `children` = sous-polygones du premier niveau, `last` = côtés du parent.
+        struct Sizes { size_t verts{ 0 }, polys{ 0 }; };
+        Sizes countSizes(LCG g, size_t children, int last, int depths) const {
+            Sizes c;
+            if (P.child_scale <= 0.0) return c;         // rayons enfants <= 0 : aucun sous-polygone
+            for (int depth = 1; depth <= depths; ++depth) {
+                size_t nextChildren = 0;
+                for (size_t k = 0; k < children; ++k) {
+                    const int sides = clampSides(g.uniformInt(P.min_sides, P.max_sides));
+                    g.next();                           // angle
+                    if (sides >= 3) { c.verts += (size_t)sides; ++c.polys; last = sides; }
+                    nextChildren += (size_t)last;
+                }
+                children = nextChildren;
             }
-            polys.push_back(Poly{ v0, sides, e0, sides, radius });
+            return c;
         }
 
-        void addBaseOctagon(double size) {
-            // size ≈ diamètre → rayon = size/2
-            addRegularPolygon({ 0.0,0.0 }, size * 0.5, 8, rng.angle());
+        void resizeOutput(t2d::Shape& out, size_t verts, size_t npolys) {
+            out.V.resize(verts); out.E.resize(verts); out.draw_order.resize(verts);
+            polys.resize(npolys);
         }
 
-        t2d::Shape build() {
-            reset();
+        void build(t2d::Shape& out) {
+            dst = &out;
+            out.V.clear(); out.E.clear(); out.draw_order.clear();   // capacité conservée
+            polys.clear(); totalV = 0;
 
-            const int r = P.fixed_iterations ? clampi(*P.fixed_iterations, 1, 4)
+            const int r = P.fixed_iterations ? clampi(*P.fixed_iterations, 1, kMaxIterations)
                 : rng.uniformInt(1, 4);
             lastIterations = r; // <-- stocké pour le getter
 
-            // 1) polygone racine : octogone
-            addBaseOctagon(P.base_size);
+            // 1) polygone racine : octogone (size ≈ diamètre → rayon = size/2)
+            const double rootAngle = rng.angle();
+            const int s0 = clampSides(8);
+            const double rootR = P.base_size * 0.5;
+            if (!emits(s0, rootR)) { dst = nullptr; return; }
 
             // 2) itérations : pour chaque sommet de chaque polygone courant → un sous-polygone régulier
-            std::vector<Poly> frontier; frontier.push_back(polys.back());
-            for (int depth = 1; depth <= r; ++depth) {
-                std::vector<Poly> next; next.reserve(frontier.size() * 8);
-                for (const Poly& pr : frontier) {
-                    const int v0 = pr.v0;
-                    const int cnt = pr.vcount;
-                    const double childR = pr.radius * P.child_scale;
-                    for (int i = 0; i < cnt; ++i) {
-                        const Vec2 center = V[v0 + i];
-                        const int  sides = rng.uniformInt(P.min_sides, P.max_sides);
-                        addRegularPolygon(center, childR, sides, rng.angle());
-                        next.push_back(polys.back());
-                    }
-                }
-                frontier.swap(next);
+            if (!P.parallel_subtrees) {
+                const Sizes sz = countSizes(rng, (size_t)s0, s0, r);
+                resizeOutput(out, (size_t)s0 + sz.verts, 1 + sz.polys);
+                Cursor c;
+                addRegularPolygon(c, { 0.0,0.0 }, rootR, s0, rootAngle);
+                expand(rng, polys[0], 0, s0, r, c, frontier, next);
             }
+            else {
+                // Un sous-arbre par sommet de l’octogone, avec son propre flux LCG::stream(clé, j) :
+                // comptage par sous-arbre -> sommes préfixes -> écriture dans des plages disjointes.
+                // Résultat identique quel que soit le nombre de threads (différent du mode séquentiel).
+                const uint64_t key = ((uint64_t)rng.next() << 32) | rng.next();
+                std::vector<Sizes> sub((size_t)s0);
+                t2d::ThreadPool& tp = pool();
+                tp.parallel_for((size_t)s0, [&](size_t j) {
+                    sub[j] = countSizes(LCG{ t2d::LCG::stream(key, j).s }, 1, s0, r);
+                    });
 
-            // 3) conversion → t2d::Shape
-            t2d::Shape out;
-            out.V.reserve(V.size());
-            out.E.reserve(E.size());
-            out.draw_order.reserve(drawOrder.size());
+                std::vector<Cursor> start((size_t)s0);
+                Cursor total{ s0, 1 };
+                for (size_t j = 0; j < (size_t)s0; ++j) {
+                    start[j] = total;
+                    total.v += (int)sub[j].verts; total.p += (int)sub[j].polys;
+                }
+                resizeOutput(out, (size_t)total.v, (size_t)total.p);
+                Cursor c;
+                addRegularPolygon(c, { 0.0,0.0 }, rootR, s0, rootAngle);
 
-            for (const auto& p : V) out.V.push_back({ p.x, p.y });
-            for (const auto& s : E) out.E.push_back({ s.a, s.b });
-            for (int idx : drawOrder) out.draw_order.push_back(idx);
+                tp.parallel_for((size_t)s0, [&](size_t j) {
+                    LCG g{ t2d::LCG::stream(key, j).s };
+                    Cursor cj = start[j];
+                    std::vector<Poly> front, nxt;
+                    expand(g, polys[0], (int)j, (int)j + 1, r, cj, front, nxt);
+                    });
+            }
 
             totalV = (int)out.V.size();
-            return out;
+            dst = nullptr;
+        }
+
+        // Parcours en profondeur (pré-ordre) : une pile de r+1 polygones, sommets recalculés à la demande.
+        StreamSummary stream(const ChunkSink& sink, size_t chunk) {
+            StreamSummary sum;
+            const int r = P.fixed_iterations ? clampi(*P.fixed_iterations, 1, kMaxStreamIterations)
+                : rng.uniformInt(1, 4);
+            lastIterations = sum.iterations = r;
+
+            // un polygone n’est jamais coupé entre deux blocs
+            chunk = std::max(chunk, (size_t)std::max(3, P.max_sides));
+            std::vector<ChunkVertex> bv; bv.reserve(chunk);
+            std::vector<ChunkSegment> be; be.reserve(chunk);
+            std::vector<uint64_t> bo; bo.reserve(chunk);
+
+            auto flush = [&] {
+                if (bv.empty()) return;
+                sink(ShapeChunk{ sum.vertices - bv.size(), bv, be, bo });
+                bv.clear(); be.clear(); bo.clear();
+                ++sum.chunks;
+            };
+
+            struct Frame {
+                Vec2 c; double radius{ 0 }, rc{ 0 }, rs{ 0 };
+                const Vec2* u{ nullptr }; int sides{ 0 }, next{ 0 };
+                Vec2 vertex(int i) const { return { c.x + (u[i].x * rc - u[i].y * rs), c.y + (u[i].x * rs + u[i].y * rc) }; }
+            };
+            std::vector<Frame> stack((size_t)r + 1);
+
+            // mêmes formules que addRegularPolygon
+            auto open = [&](Frame& f, const Vec2& center, double radius, int sides, double orientRad) {
+                f = Frame{ center, radius, radius * std::cos(orientRad), radius * std::sin(orientRad),
+                           unit.data() + unitOff[sides - unitLo], sides, 0 };
+                if (bv.size() + (size_t)sides > chunk) flush();
+                const uint64_t v0 = sum.vertices;
+                for (int i = 0; i < sides; ++i) {
+                    const Vec2 p = f.vertex(i);
+                    bv.push_back({ p.x, p.y });
+                    be.push_back({ v0 + (uint64_t)i, v0 + (uint64_t)((i + 1) % sides) });
+                    bo.push_back(v0 + (uint64_t)i);
+                }
+                sum.vertices += (uint64_t)sides; sum.segments += (uint64_t)sides; ++sum.polygons;
+            };
+
+            const double rootAngle = rng.angle();
+            const int s0 = clampSides(8);
+            const double rootR = P.base_size * 0.5;
+            if (!emits(s0, rootR)) return sum;
+            open(stack[0], { 0.0,0.0 }, rootR, s0, rootAngle);
+
+            for (int depth = 0; depth >= 0; ) {
+                Frame& f = stack[(size_t)depth];
+                if (depth == r || f.next == f.sides) { --depth; continue; }
+                const Vec2 center = f.vertex(f.next++);
+                const double childR = f.radius * P.child_scale;
+                const int sides = clampSides(rng.uniformInt(P.min_sides, P.max_sides));
+                const double angle = rng.angle();
+                if (!emits(sides, childR)) continue;
+                open(stack[(size_t)depth + 1], center, childR, sides, angle);
+                ++depth;
+            }
+            flush();
+            return sum;
         }
     };
 
@@ -122,12 +278,77 @@ namespace t2dgen {
     RandomGenPolyShape::RandomGenPolyShape(Params p) : d_(new Impl(p)) {}
     RandomGenPolyShape::~RandomGenPolyShape() { delete d_; }
 
-    t2d::Shape RandomGenPolyShape::generate() { return d_->build(); }
+    t2d::Shape RandomGenPolyShape::generate() { t2d::Shape out; generate_into(out); return out; }
+    void RandomGenPolyShape::generate_into(t2d::Shape& out) {
+        T2D_PERF_TIMER(shape_ns);
+        T2D_PERF_ONLY(const uint64_t bytes0 = t2d::perf::bytes_of(out.V) + t2d::perf::bytes_of(out.E) + t2d::perf::bytes_of(out.draw_order);)
+        d_->build(out);
+        T2D_PERF_ADD(vertices, out.V.size());
+        T2D_PERF_ADD(shape_bytes, t2d::perf::bytes_of(out.V) + t2d::perf::bytes_of(out.E) + t2d::perf::bytes_of(out.draw_order) - bytes0);
+    }
+    StreamSummary RandomGenPolyShape::generate_stream(const ChunkSink& sink, std::size_t chunk_vertices) {
+        return d_->stream(sink, chunk_vertices);
+    }
     int RandomGenPolyShape::totalVertices() const { return d_->totalV; }
     int RandomGenPolyShape::iterations()    const { return d_->lastIterations; }
 
+    // --- Vue paresseuse ---
+    // clé(racine) = stream(seed, 0) ; clé(enfant i) = stream(clé(parent), i) ;
+    // un LCG initialisé à la clé tire (r,) côtés puis angle
+
+    LazyShapeView::LazyShapeView(const Params& p) : P_(p) {
+        rootKey_ = t2d::LCG::stream(p.seed, 0).s;
+        LCG g{ rootKey_ };
+        r_ = p.fixed_iterations ? clampi(*p.fixed_iterations, 1, kMaxDepth) : g.uniformInt(1, 4);
+        rootAngle_ = g.angle();
+    }
+
+    LazyShapeView::Polygon LazyShapeView::polygon(const Path& path) const {
+        Polygon pg;
+        if (!path.valid() || path.depth > r_) return pg;
+        pg.sides = clampi(8, P_.min_sides, P_.max_sides);
+        pg.radius = P_.base_size * 0.5;
+        pg.angle = rootAngle_;
+        pg.key = rootKey_;
+        for (int k = 0; k < path.depth; ++k) {
+            if (pg.sides < 3 || pg.radius <= 0.0 || path.at[k] >= pg.sides) return Polygon{};
+            const double a = pg.angle + path.at[k] * (2.0 * kPI / (double)pg.sides);
+            pg.cx += pg.radius * std::cos(a);
+            pg.cy += pg.radius * std::sin(a);
+            pg.radius *= P_.child_scale;
+            pg.key = t2d::LCG::stream(pg.key, path.at[k]).s;
+            LCG g{ pg.key };
+            pg.sides = clampi(g.uniformInt(P_.min_sides, P_.max_sides), P_.min_sides, P_.max_sides);
+            pg.angle = g.angle();
+        }
+        pg.exists = pg.sides >= 3 && pg.radius > 0.0;
+        return pg;
+    }
+
+    bool LazyShapeView::vertex(const Path& path, int i, ChunkVertex& out) const {
+        const Polygon pg = polygon(path);
+        if (!pg.exists || i < 0 || i >= pg.sides) return false;
+        const double a = pg.angle + i * (2.0 * kPI / (double)pg.sides);
+        out = { pg.cx + pg.radius * std::cos(a), pg.cy + pg.radius * std::sin(a) };
+        return true;
+    }
+
+    bool LazyShapeView::segment(const Path& path, int i, VertexRef& a, VertexRef& b) const {
+        const Polygon pg = polygon(path);
+        if (!pg.exists || i < 0 || i >= pg.sides) return false;
+        a = { path, i };
+        b = { path, (i + 1) % pg.sides };
+        return true;
+    }
+
+    bool LazyShapeView::parentVertex(const Path& path, VertexRef& out) const {
+        if (path.depth <= 0 || !polygon(path).exists) return false;
+        out = { path.parent(), path.at[path.depth - 1] };
+        return true;
+    }
+
     long long RandomGenPolyShape::theoreticalMaxVertices(int r) {
-        r = clampi(r, 1, 4);
+        r = clampi(r, 1, kMaxStreamIterations);   // 8 + 8 * Σ(8^d) < 2^63 jusqu’à r = 19
         long long sum = 0, p = 8; // 8^1 + 8^2 + ... + 8^r
         for (int d = 1; d <= r; ++d) { sum += p; p *= 8; }
         return 8 + 8 * sum; // 8 (base) + 8 * Σ(8^d)
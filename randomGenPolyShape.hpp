@@ -1,22 +1,51 @@
 ﻿#pragma once
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <optional>
+#include <span>
+#include <functional>
 
 // Forward-declare uniquement : évite de dépendre du contenu de time2d_m2.h côté .hpp
 namespace t2d { struct Shape; }
 
 namespace t2dgen {
 
+    // ---------- Flux par blocs (forme non matérialisée, indices 64 bits) ----------
+    struct ChunkVertex { double x{}, y{}; };
+    struct ChunkSegment { std::uint64_t a{ 0 }, b{ 0 }; };   // indices GLOBAUX de sommets
+
+    // Bloc de polygones entiers ; sommet k du bloc = sommet global first + k = segment global first + k
+    struct ShapeChunk {
+        std::uint64_t                  first{ 0 };
+        std::span<const ChunkVertex>   V;
+        std::span<const ChunkSegment>  E;
+        std::span<const std::uint64_t> draw_order;
+    };
+    using ChunkSink = std::function<void(const ShapeChunk&)>;   // spans valides pendant l’appel seulement
+
+    struct StreamSummary {
+        std::uint64_t vertices{ 0 }, segments{ 0 }, polygons{ 0 }, chunks{ 0 };
+        int           iterations{ 0 };
+    };
+
     class RandomGenPolyShape {
     public:
+        static constexpr int kMaxIterations = 4;          // generate / generate_into (forme en mémoire)
+        static constexpr int kMaxStreamIterations = 8;    // generate_stream
+
         struct Params {
             double              base_size{ 1.0 };          // "diamètre" approx de l'octogone racine
             double              child_scale{ 0.25 };       // 1/4 de la taille du parent
             int                 min_sides{ 3 };            // bornes des sous-polygones
             int                 max_sides{ 8 };
-            std::optional<int>  fixed_iterations;        // sinon tirage aléatoire [1..4]
+            std::optional<int>  fixed_iterations;        // sinon tirage aléatoire [1..4] ; borné [1..8] en flux
             std::uint64_t       seed{ 0xC0FFEEULL };       // reproductibilité
+
+            // Mode parallèle : un sous-arbre par sommet de l’octogone racine, graine dérivée par sous-arbre.
+            // Forme identique quel que soit `threads` (mais différente du mode séquentiel).
+            bool                parallel_subtrees{ false };
+            unsigned            threads{ 0 };              // 0 : pool partagé, sinon pool dédié de n threads
         };
 
         explicit RandomGenPolyShape(Params p = {});
@@ -25,10 +54,19 @@ namespace t2dgen {
         // Génère la forme hiérarchique et la convertit en t2d::Shape (définie dans time2d_m2.h)
         t2d::Shape generate();
 
+        // Idem, écrit directement dans `out` (contenu remplacé, capacité réutilisée d’un appel à l’autre)
+        void generate_into(t2d::Shape& out);
+
+        // Génération en flux (r jusqu’à kMaxStreamIterations) : parcours en profondeur, sommets / segments /
+        // draw_order envoyés à `sink` par blocs d’au plus `chunk_vertices` sommets. Mémoire O(chunk + r).
+        // Ordre d’émission (DFS) et tirages différents de generate() ; un polygone rejeté n’a pas de
+        // descendants ; parallel_subtrees ignoré.
+        StreamSummary generate_stream(const ChunkSink& sink, std::size_t chunk_vertices = 65536);
+
         // Métriques
-        int totalVertices() const;                        // N effectif de la dernière génération
-        int iterations()   const;                         // r tiré/effectif (1..4)
-        static long long theoreticalMaxVertices(int iterations_1_to_4);
+        int totalVertices() const;                        // N effectif de la dernière génération (hors flux)
+        int iterations()   const;                         // r tiré/effectif (1..4, 1..8 en flux)
+        static long long theoreticalMaxVertices(int iterations_1_to_8);
 
     private:
         // Implémentation cachée (PImpl)
@@ -36,4 +74,49 @@ namespace t2dgen {
         Impl* d_;
     };
 
+    // ---------- Vue paresseuse adressée par chemin (aucune génération globale) ----------
+    // Polygone = chemin depuis la racine (at[k] = sommet du polygone de niveau k portant le niveau k+1).
+    // Côtés et rotation de chaque polygone dérivés d’un hachage (seed, chemin) : sommet, parent et
+    // segments calculés en O(profondeur), mémoire O(1). Mêmes règles géométriques que generate()
+    // (octogone racine, rayon × child_scale par niveau, côtés bornés) mais tirages différents.
+    class LazyShapeView {
+    public:
+        using Params = RandomGenPolyShape::Params;
+        static constexpr int kMaxDepth = 16;
+
+        struct Path {
+            int depth{ 0 };                                // 0 = octogone racine ; -1 = chemin invalide
+            std::uint8_t at[kMaxDepth]{};
+            bool valid() const { return depth >= 0 && depth <= kMaxDepth; }
+            // au-delà de kMaxDepth ou i hors [0..255] : chemin invalide (rejeté par polygon())
+            Path child(int i) const {
+                if (depth < 0 || depth >= kMaxDepth || i < 0 || i > 255) return Path{ -1 };
+                Path c = *this; c.at[c.depth++] = (std::uint8_t)i; return c;
+            }
+            Path parent() const { Path c = *this; if (c.valid() && c.depth > 0) c.at[--c.depth] = 0; return c; }
+        };
+        struct Polygon {
+            bool          exists{ false };                 // faux : chemin hors forme ou polygone rejeté
+            int           sides{ 0 };
+            double        cx{ 0 }, cy{ 0 }, radius{ 0 }, angle{ 0 };
+            std::uint64_t key{ 0 };                        // hachage (seed, chemin)
+        };
+        struct VertexRef { Path poly; int i{ 0 }; };
+
+        explicit LazyShapeView(const Params& p);
+
+        int iterations() const { return r_; }              // fixed_iterations borné [1..kMaxDepth], sinon haché [1..4]
+
+        Polygon polygon(const Path& path) const;
+        bool vertex(const Path& path, int i, ChunkVertex& out) const;          // sommet i du polygone
+        bool segment(const Path& path, int i, VertexRef& a, VertexRef& b) const; // segment i : (i, i+1 mod côtés)
+        bool parentVertex(const Path& path, VertexRef& out) const;            // sommet portant ce polygone
+
+    private:
+        Params P_;
+        int r_{ 1 };
+        std::uint64_t rootKey_{ 0 };
+        double rootAngle_{ 0 };
+    };
+
 } // namespace t2dgen
@@ -0,0 +1,204 @@
+﻿#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "randomGenPolyShape.hpp"
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+#include "time2d_macros.h"
+#include "time2d_pool.h"
+
+namespace t2d {
+
+    // -----------------------------
+    // Statistiques en flux (mémoire constante, fusionnables)
+    // -----------------------------
+
+    // Welford : moyenne / variance + min / max ; merge = formule de Chan (ordre de fusion fixé => déterministe)
+    struct RunningStats {
+        uint64_t n{ 0 };
+        double   mean{ 0.0 };
+        double   m2{ 0.0 };     // somme des carrés des écarts
+        double   min{ std::numeric_limits<double>::infinity() };
+        double   max{ -std::numeric_limits<double>::infinity() };
+
+        void add(double x) {
+            ++n;
+            const double d = x - mean;
+            mean += d / (double)n;
+            m2 += d * (x - mean);
+            min = std::min(min, x); max = std::max(max, x);
+        }
+
+        void merge(const RunningStats& o) {
+            if (o.n == 0) return;
+            if (n == 0) { *this = o; return; }
+            const double na = (double)n, nb = (double)o.n, nt = na + nb;
+            const double d = o.mean - mean;
+            mean += d * (nb / nt);
+            m2 += o.m2 + d * d * (na * nb / nt);
+            n += o.n;
+            min = std::min(min, o.min); max = std::max(max, o.max);
+        }
+
+        double variance() const { return (n > 1) ? m2 / (double)(n - 1) : 0.0; }
+        double stddev()   const { return std::sqrt(variance()); }
+    };
+
+    // Quantiles approchés à erreur RELATIVE bornée (~1 %) : seaux logarithmiques de base
+    // gamma = (1+a)/(1-a) sur [1e-9, 1e12] (bornés aux extrémités), valeurs <= 0 dans un seau zéro.
+    // Taille fixe, fusion = somme des comptes (exacte, indépendante de l’ordre).
+    struct QuantileSketch {
+        static constexpr double kAlpha = 0.01;
+        static constexpr double kMin = 1e-9, kMax = 1e12;
+        static constexpr int    kBuckets = 2432;    // >= ceil(log(kMax/kMin) / log(gamma)) + 1
+
+        std::array<uint64_t, kBuckets> counts{};
+        uint64_t zeros{ 0 };
+        uint64_t n{ 0 };
+
+        static double gamma() { return (1.0 + kAlpha) / (1.0 - kAlpha); }
+
+        void add(double x) {
+            ++n;
+            if (!(x > 0.0)) { ++zeros; return; }
+            const double v = std::clamp(x, kMin, kMax);
+            const int k = (int)std::ceil(std::log(v / kMin) / std::log(gamma()));
+            ++counts[(size_t)std::clamp(k, 0, kBuckets - 1)];
+        }
+
+        void merge(const QuantileSketch& o) {
+            for (int k = 0; k < kBuckets; ++k) counts[(size_t)k] += o.counts[(size_t)k];
+            zeros += o.zeros; n += o.n;
+        }
+
+        // q dans [0,1] ; 0 si vide
+        double quantile(double q) const {
+            if (n == 0) return 0.0;
+            const uint64_t rank = (uint64_t)std::floor(std::clamp(q, 0.0, 1.0) * (double)(n - 1));
+            if (rank < zeros) return 0.0;
+            uint64_t acc = zeros;
+            const double g = gamma();
+            for (int k = 0; k < kBuckets; ++k) {
+                acc += counts[(size_t)k];
+                if (acc > rank) return kMin * std::pow(g, (double)k) * 2.0 / (1.0 + g); // milieu du seau
+            }
+            return kMax;
+        }
+    };
+
+    struct StreamStats {
+        RunningStats   moments;
+        QuantileSketch sketch;
+        void add(double x) { moments.add(x); sketch.add(x); }
+        void merge(const StreamStats& o) { moments.merge(o.moments); sketch.merge(o.sketch); }
+    };
+
+    // -----------------------------
+    // Ensemble Monte Carlo : pipelines graine par graine, repliés dans des StreamStats
+    // -----------------------------
+    struct EnsembleSpec {
+        t2dgen::RandomGenPolyShape::Params shape{};   // seed remplacée par run
+        M2Params       m2{};                            // seed remplacée par run
+        I2Params       i2{};                            // seed / N / r remplacés par run
+        LatencyTargets targets{};
+        MacroParams    macro{};
+        int            retention_factor{ 4 };           // >0 : cibles dérivées comme metatime
+        int            replicas_divisor{ 20 };          // >0 : k = N / divisor (borné [1, N-1]) comme metatime
+
+        uint64_t       base_seed{ 0xC0FFEEULL };        // run i : sous-flux LCG::stream(base_seed, i)
+        uint64_t       runs{ 1000 };
+        uint32_t       block{ 256 };                    // runs par accumulateur partiel (fixe => déterminisme)
+    };
+
+    struct EnsembleStats {
+        uint64_t    runs{ 0 };
+        StreamStats vertices_n;
+        StreamStats grains_memorized;
+        StreamStats rate_memorized;
+        StreamStats thunder_tau;
+        StreamStats MEMORY_LATENCY_TIME_FACTOR_low;
+        StreamStats MEMORY_LATENCY_TIME_FACTOR_high;
+        StreamStats CONTAINER_RANGE_TIME;
+
+        void merge(const EnsembleStats& o) {
+            runs += o.runs;
+            vertices_n.merge(o.vertices_n);
+            grains_memorized.merge(o.grains_memorized);
+            rate_memorized.merge(o.rate_memorized);
+            thunder_tau.merge(o.thunder_tau);
+            MEMORY_LATENCY_TIME_FACTOR_low.merge(o.MEMORY_LATENCY_TIME_FACTOR_low);
+            MEMORY_LATENCY_TIME_FACTOR_high.merge(o.MEMORY_LATENCY_TIME_FACTOR_high);
+            CONTAINER_RANGE_TIME.merge(o.CONTAINER_RANGE_TIME);
+        }
+    };
+
+    // un run complet ; rien n’est conservé au-delà de l’appel (M2Plan / I2Plan locaux,
+    // `shape` = tampon de travail réutilisé d’un run à l’autre)
+    inline void _ensemble_run(const EnsembleSpec& spec, uint64_t run, Shape& shape, EnsembleStats& acc) {
+        t2d::LCG seeds = t2d::LCG::stream(spec.base_seed, run);
+        auto seed64 = [&] { const uint64_t hi = seeds.next(); return (hi << 32) | seeds.next(); };
+
+        t2dgen::RandomGenPolyShape::Params sp = spec.shape;
+        sp.seed = seed64();
+        t2dgen::RandomGenPolyShape gen(sp);
+        gen.generate_into(shape);
+        const int N = (int)shape.V.size();
+
+        M2Params mp = spec.m2;
+        mp.seed = seed64();
+        if (spec.replicas_divisor > 0) mp.replicas_k = std::min(std::max(1, N / spec.replicas_divisor), std::max(1, N - 1));
+        const M2Plan m2 = generate_m2(shape, mp);
+
+        I2Params ip = spec.i2;
+        ip.seed = seed64();
+        ip.total_vertices_n = N;
+        ip.iterations_inherited = gen.iterations();
+        const I2Plan i2 = _i2_plan_from_counts(_i2_flow(m2, ip), count_i2(m2, ip));
+
+        LatencyTargets tgt = spec.targets;
+        if (spec.retention_factor > 0) {
+            tgt.target_lost_exact = std::max(0, i2.grains_lost / spec.retention_factor);
+            tgt.target_mem_min = std::max(0, i2.grains_total - tgt.target_lost_exact);
+        }
+        const Macros mx = compute_macros(i2, ip, m2, tgt, spec.macro);
+
+        ++acc.runs;
+        acc.vertices_n.add((double)N);
+        acc.grains_memorized.add((double)i2.grains_memorized);
+        acc.rate_memorized.add(i2.rate_memorized);
+        acc.thunder_tau.add(m2.thunder_tau);
+        acc.MEMORY_LATENCY_TIME_FACTOR_low.add(mx.MEMORY_LATENCY_TIME_FACTOR_low);
+        acc.MEMORY_LATENCY_TIME_FACTOR_high.add(mx.MEMORY_LATENCY_TIME_FACTOR_high);
+        acc.CONTAINER_RANGE_TIME.add((double)mx.CONTAINER_RANGE_TIME);
+    }
+
+    // Les runs sont groupés en blocs de `block` ; les blocs sont traités par vagues de taille bornée
+    // (accumulateurs réutilisés) et fusionnés dans l’ordre des blocs : mémoire constante quel que
+    // soit `runs`, résultat identique pour tout nombre de threads.
+    inline EnsembleStats run_ensemble(const EnsembleSpec& spec, ThreadPool& pool = ThreadPool::shared()) {
+        EnsembleStats total;
+        const uint64_t block = std::max<uint32_t>(1, spec.block);
+        const uint64_t blocks = (spec.runs + block - 1) / block;
+        const uint64_t wave = 4ull * pool.size();
+
+        std::vector<EnsembleStats> partial((size_t)std::min(wave, std::max<uint64_t>(1, blocks)));
+        for (uint64_t b0 = 0; b0 < blocks; b0 += wave) {
+            const uint64_t nb = std::min(wave, blocks - b0);
+            pool.parallel_for((size_t)nb, [&](size_t w) {
+                EnsembleStats& acc = partial[w];
+                acc = EnsembleStats{};
+                const uint64_t r0 = (b0 + w) * block, r1 = std::min(spec.runs, r0 + block);
+                Shape shape;
+                for (uint64_t run = r0; run < r1; ++run) _ensemble_run(spec, run, shape, acc);
+                });
+            for (uint64_t w = 0; w < nb; ++w) total.merge(partial[(size_t)w]);
+        }
+        return total;
+    }
+
+} // namespace t2d
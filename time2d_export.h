@@ -0,0 +1,246 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+
+namespace t2d {
+
+    // -----------------------------
+    // Export colonnaire en flux (CSV / binaire par blocs)
+    // -----------------------------
+    // Les lignes sont écrites au fil de leur production : tampon fixe, std::to_chars, fwrite par blocs.
+    // Aucune allocation ni formatage iostream par ligne ; le débit est borné par le disque.
+    // Les deux écrivains ont la même interface (put(...) colonne par colonne, puis end_row()),
+    // les exporteurs plus bas sont donc génériques.
+
+    enum class ColType : uint8_t { I32 = 1, F64 = 2, U8 = 3 };
+
+    struct Column {
+        const char* name;
+        ColType     type;
+    };
+
+    inline size_t col_size(ColType t) {
+        switch (t) {
+        case ColType::I32: return 4;
+        case ColType::F64: return 8;
+        case ColType::U8:  return 1;
+        }
+        return 0;
+    }
+
+    // ---------- fichier tamponné ----------
+    class _BufferedFile {
+    public:
+        explicit _BufferedFile(const std::string& path, size_t buffer_bytes)
+            : f_(std::fopen(path.c_str(), "wb")), buf_(std::max<size_t>(buffer_bytes, 4096)) {
+            if (f_) std::setvbuf(f_, nullptr, _IONBF, 0);   // notre tampon suffit
+        }
+        _BufferedFile(const _BufferedFile&) = delete;
+        _BufferedFile& operator=(const _BufferedFile&) = delete;
+        ~_BufferedFile() { close(); }
+
+        bool ok() const { return f_ && !err_; }
+
+        // réserve n octets contigus (n <= capacité) et renvoie le pointeur d’écriture
+        char* reserve(size_t n) {
+            if (len_ + n > buf_.size()) flush();
+            return buf_.data() + len_;
+        }
+        void commit(size_t n) { len_ += n; }
+
+        void write(const void* d, size_t n) {
+            if (n > buf_.size()) { flush(); raw(d, n); return; }
+            std::memcpy(reserve(n), d, n); commit(n);
+        }
+
+        void flush() { if (len_) { raw(buf_.data(), len_); len_ = 0; } }
+
+        bool close() {
+            if (!f_) return false;
+            flush();
+            if (std::fclose(f_) != 0) err_ = true;
+            f_ = nullptr;
+            return !err_;
+        }
+
+        size_t capacity() const { return buf_.size(); }
+
+    private:
+        void raw(const void* d, size_t n) {
+            if (f_ && std::fwrite(d, 1, n, f_) != n) err_ = true;
+        }
+
+        std::FILE* f_;
+        std::vector<char> buf_;
+        size_t len_{ 0 };
+        bool   err_{ false };
+    };
+
+    // ---------- CSV ----------
+    // doubles au format le plus court relisible exactement (std::to_chars), ligne d’en-tête incluse.
+    class CsvWriter {
+    public:
+        CsvWriter(const std::string& path, std::initializer_list<Column> cols, size_t buffer_bytes = 1 << 20)
+            : out_(path, buffer_bytes), ncols_(cols.size()) {
+            size_t c = 0;
+            for (const Column& col : cols) {
+                if (c++) out_.write(",", 1);
+                out_.write(col.name, std::strlen(col.name));
+            }
+            out_.write("\n", 1);
+        }
+
+        void put(int32_t v) { sep(); char* p = out_.reserve(16); commit(p, std::to_chars(p, p + 16, v).ptr); }
+        void put(uint8_t v) { put((int32_t)v); }
+        void put(double v)  { sep(); char* p = out_.reserve(32); commit(p, std::to_chars(p, p + 32, v).ptr); }
+        void end_row() {
+            if (col_ != ncols_) bad_ = true;   // ligne incomplète ou trop longue : fichier invalide
+            out_.write("\n", 1); col_ = 0; ++rows_;
+        }
+
+        uint64_t rows() const { return rows_; }
+        bool ok() const { return out_.ok() && !bad_; }
+        bool close() { return out_.close() && !bad_; }
+
+    private:
+        void sep() { if (col_++) { *out_.reserve(1) = ','; out_.commit(1); } }
+        void commit(char* b, char* e) { out_.commit((size_t)(e - b)); }
+
+        _BufferedFile out_;
+        size_t   ncols_;
+        size_t   col_{ 0 };
+        uint64_t rows_{ 0 };
+        bool     bad_{ false };
+    };
+
+    // ---------- binaire colonnaire par blocs ----------
+    // Little-endian :
+    //   "T2DCOLS\0" | u32 version | u32 ncols | ncols × (u8 type, u8 len, nom[len])
+    //   blocs : u32 rows | u32 0 | colonne 0 (rows × taille) | colonne 1 | ...
+    //   fin   : bloc à rows = 0
+    // Chaque bloc (chunk_rows lignes au plus) est accumulé colonne par colonne puis écrit d’un coup.
+    class ColumnWriter {
+    public:
+        static constexpr uint32_t kVersion = 1;
+
+        ColumnWriter(const std::string& path, std::initializer_list<Column> cols,
+            size_t chunk_rows = 65536, size_t buffer_bytes = 1 << 20)
+            : out_(path, buffer_bytes), chunk_rows_(std::max<size_t>(1, chunk_rows)) {
+            for (const Column& c : cols) { types_.push_back(c.type); names_.push_back(c.name); }
+            cols_.resize(types_.size());
+            for (size_t c = 0; c < cols_.size(); ++c) cols_[c].resize(chunk_rows_ * col_size(types_[c]));
+
+            const uint32_t head[2] = { kVersion, (uint32_t)types_.size() };
+            out_.write("T2DCOLS", 8);
+            out_.write(head, sizeof head);
+            for (size_t c = 0; c < types_.size(); ++c) {
+                const uint8_t meta[2] = { (uint8_t)types_[c], (uint8_t)std::min<size_t>(255, names_[c].size()) };
+                out_.write(meta, 2);
+                out_.write(names_[c].data(), meta[1]);
+            }
+        }
+        ~ColumnWriter() { close(); }
+
+        void put(int32_t v) { store(&v, ColType::I32); }
+        void put(uint8_t v) { store(&v, ColType::U8); }
+        void put(double v)  { store(&v, ColType::F64); }
+        void end_row() {
+            // ligne incomplète : non comptée (ses colonnes garderaient les octets d’une ligne précédente)
+            if (col_ != types_.size()) { bad_ = true; col_ = 0; return; }
+            col_ = 0; ++rows_;
+            if (++fill_ == chunk_rows_) flush_chunk();
+        }
+
+        uint64_t rows() const { return rows_; }
+        bool ok() const { return out_.ok() && !bad_; }
+
+        bool close() {
+            if (closed_) return ok();
+            flush_chunk();
+            const uint32_t end[2] = { 0, 0 };
+            out_.write(end, sizeof end);
+            closed_ = true;
+            return out_.close() && !bad_;
+        }
+
+    private:
+        void store(const void* v, ColType t) {
+            if (col_ >= types_.size() || types_[col_] != t) { bad_ = true; return; }   // schéma non respecté
+            const size_t sz = col_size(t);
+            std::memcpy(cols_[col_].data() + fill_ * sz, v, sz);
+            ++col_;
+        }
+
+        void flush_chunk() {
+            if (!fill_) return;
+            const uint32_t head[2] = { (uint32_t)fill_, 0 };
+            out_.write(head, sizeof head);
+            for (size_t c = 0; c < cols_.size(); ++c) out_.write(cols_[c].data(), fill_ * col_size(types_[c]));
+            fill_ = 0;
+        }
+
+        _BufferedFile out_;
+        std::vector<ColType> types_;
+        std::vector<std::string> names_;
+        std::vector<std::vector<char>> cols_;
+        size_t   chunk_rows_;
+        size_t   fill_{ 0 }, col_{ 0 };
+        uint64_t rows_{ 0 };
+        bool     bad_{ false }, closed_{ false };
+    };
+
+    // -----------------------------
+    // Exporteurs (W = CsvWriter ou ColumnWriter, construit avec le schéma correspondant)
+    // -----------------------------
+    inline constexpr std::initializer_list<Column> kM2EventColumns = {
+        { "tick", ColType::F64 }, { "op", ColType::U8 },
+        { "vertex", ColType::I32 }, { "edge", ColType::I32 }, { "cluster", ColType::I32 }
+    };
+
+    inline constexpr std::initializer_list<Column> kI2GrainColumns = {
+        { "id", ColType::I32 }, { "life", ColType::F64 }, { "wait_time", ColType::F64 },
+        { "finish_time", ColType::F64 }, { "memorized", ColType::U8 }
+    };
+
+    template <class W>
+    inline void _put_event(W& w, const EventTick& e) {
+        w.put(e.tick); w.put((uint8_t)e.op);
+        w.put((int32_t)e.vertex); w.put((int32_t)e.edge); w.put((int32_t)e.cluster);
+        w.end_row();
+    }
+
+    // événements d’un plan déjà calculé (AoS ou colonnes)
+    template <class W>
+    inline void export_m2_events(const M2Plan& m2, W& w) {
+        const size_t n = m2.event_count();
+        for (size_t i = 0; i < n; ++i) _put_event(w, m2.event(i));
+    }
+
+    // événements produits à la volée (sans matérialiser M2Plan::events)
+    template <class W>
+    inline void export_m2_events(M2EventStepper& st, W& w) {
+        EventTick e;
+        while (st.next(e)) _put_event(w, e);
+    }
+
+    // trace complète de TOUS les grains (indépendante de sample_max) ; renvoie les comptes
+    template <class W>
+    inline I2Counts export_i2_grains(const M2Plan& m2, const I2Params& P, W& w) {
+        return simulate_i2_grains(_i2_flow(m2, P), P, [&](const I2GrainSample& g) {
+            w.put((int32_t)g.id); w.put(g.life); w.put(g.wait_time); w.put(g.finish_time);
+            w.put((uint8_t)(g.memorized ? 1 : 0));
+            w.end_row();
+            });
+    }
+
+} // namespace t2d
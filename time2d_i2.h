@@ -4,7 +4,12 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
+#include <bit>
+#include <limits>
+#include <span>
 #include "time2d_m2.h"   // M2Plan, clampi/clampd, LCG dispo dans namespace t2d
+#include "time2d_i2_simd.h" // noyau vectoriel (comptes seuls)
+#include "time2d_pool.h"     // ThreadPool (generate_i2_parallel)
 
 namespace t2d {
 
@@ -73,6 +78,13 @@ namespace t2d {
         std::vector<I2GrainSample> samples; // échantillon de quelques grains
     };
 
+    // Comptes agrégés d’une simulation i2 (sans échantillons) : POD, aucune allocation
+    struct I2Counts {
+        int     grains_memorized{};
+        int     grains_lost{};
+        double  sum_finish_mem{};     // somme des finish_time des mémorisés
+    };
+
     // util interne : tirage d’un facteur U[1-j, 1+j] borné >= 0
     inline double _jitter_factor(double j, t2d::LCG& rng) {
         j = std::clamp(j, 0.0, 0.99); // eviter négatif
@@ -81,13 +93,20 @@ namespace t2d {
         return std::max(0.0, f);
     }
 
-    // Génération i2 à partir d’un plan M2 (déjà calculé) + paramètres i2.
-    // Hypothèses :
-    // - Tous les grains sont “dans le réservoir haut” au temps 0 et passent par UNE ouverture.
-    // - Débit constant (force uniforme) ⇒ file FIFO avec temps de service constant (= 1/throughput).
-    // - Chaque grain a une durée de vie tirée (glace). S’il n’atteint pas la fin du passage avant d’expirer ⇒ perdu (oubli).
-    inline I2Plan generate_i2(const M2Plan& m2, const I2Params& P) {
-        I2Plan out;
+    // Géométrie de l’écoulement (étapes 1..4 de generate_i2), sans simulation ni allocation
+    struct I2Flow {
+        int     replicas_k{};
+        int     total_vertices_n{};
+        int     iterations_inherited{};
+        double  inverse_ratio{};
+        int     grains_total{};
+        double  passage_dimension{};
+        double  throughput{};
+        double  service_time{};
+    };
+
+    inline I2Flow _i2_flow(const M2Plan& m2, const I2Params& P) {
+        I2Flow out;
         out.replicas_k = m2.replicas_effective;
         out.iterations_inherited = std::max(1, P.iterations_inherited);
 
@@ -119,44 +138,282 @@ namespace t2d {
         // 4) Débit / temps de service
         out.throughput = std::max(1e-9, P.force_rate * out.passage_dimension);
         out.service_time = 1.0 / out.throughput;
+        return out;
+    }
 
-        // 5) Simulation de l’écoulement + glace (durée de vie)
-        t2d::LCG rng{ P.seed };
-        int mem = 0, lost = 0;
-        double sum_finish_mem = 0.0;
+    inline I2Plan _i2_plan_from_flow(const I2Flow& fl) {
+        I2Plan out;
+        out.replicas_k = fl.replicas_k;
+        out.total_vertices_n = fl.total_vertices_n;
+        out.iterations_inherited = fl.iterations_inherited;
+        out.inverse_ratio = fl.inverse_ratio;
+        out.grains_total = fl.grains_total;
+        out.passage_dimension = fl.passage_dimension;
+        out.throughput = fl.throughput;
+        out.service_time = fl.service_time;
+        return out;
+    }
 
-        // on échantillonne quelques grains seulement (pour debug/inspection)
-        out.samples.clear(); out.samples.reserve(std::min(out.grains_total, P.sample_max));
+    // I2Plan (sans échantillons) reconstruit à partir de comptes seuls
+    inline I2Plan _i2_plan_from_counts(const I2Flow& fl, const I2Counts& c) {
+        I2Plan out = _i2_plan_from_flow(fl);
+        out.grains_memorized = c.grains_memorized;
+        out.grains_lost = c.grains_lost;
+        out.rate_memorized = (double)c.grains_memorized / (double)fl.grains_total;
+        out.mean_finish_time = (c.grains_memorized > 0) ? (c.sum_finish_mem / (double)c.grains_memorized) : 0.0;
+        return out;
+    }
+
+    // Simulation grain par grain (étape 5) : visit(const I2GrainSample&) est appelé pour CHAQUE grain,
+    // dans l’ordre, sans allocation. Mêmes tirages que generate_i2 ; renvoie les comptes.
+    // Sert aux traces complètes (time2d_export.h) quand sample_max ne suffit pas.
+    template <class Visit>
+    inline I2Counts simulate_i2_grains(const I2Flow& fl, const I2Params& P, Visit&& visit) {
+        t2d::LCG rng{ P.seed };
+        I2Counts c;
 
-        for (int i = 0; i < out.grains_total; ++i) {
+        for (int i = 0; i < fl.grains_total; ++i) {
             // File FIFO M/M/1 déterministe (service constant) : chaque grain attend (i)*service_time
-            const double wait = (double)i * out.service_time;
-            const double finish = wait + out.service_time;
+            const double wait = (double)i * fl.service_time;
+            const double finish = wait + fl.service_time;
 
             // Glace : durée de vie tirée autour de life_mean
             const double life = P.life_mean * _jitter_factor(P.life_jitter, rng);
 
             const bool ok = (life >= finish); // opérabilité : converge vers une même valeur finale (ici, franchit l’ouverture)
-            if (ok) { ++mem; sum_finish_mem += finish; }
-            else { ++lost; }
-
-            if ((int)out.samples.size() < P.sample_max) {
-                out.samples.push_back(I2GrainSample{
-                  .id = i,
-                  .life = life,
-                  .wait_time = wait,
-                  .pass_time = out.service_time,
-                  .finish_time = finish,
-                  .memorized = ok
-                    });
+            if (ok) { ++c.grains_memorized; c.sum_finish_mem += finish; }
+            else { ++c.grains_lost; }
+
+            visit(I2GrainSample{
+              .id = i,
+              .life = life,
+              .wait_time = wait,
+              .pass_time = fl.service_time,
+              .finish_time = finish,
+              .memorized = ok
+                });
+        }
+        return c;
+    }
+
+    // Génération i2 à partir d’un plan M2 (déjà calculé) + paramètres i2.
+    // Hypothèses :
+    // - Tous les grains sont “dans le réservoir haut” au temps 0 et passent par UNE ouverture.
+    // - Débit constant (force uniforme) ⇒ file FIFO avec temps de service constant (= 1/throughput).
+    // - Chaque grain a une durée de vie tirée (glace). S’il n’atteint pas la fin du passage avant d’expirer ⇒ perdu (oubli).
+    inline I2Plan generate_i2(const M2Plan& m2, const I2Params& P) {
+        T2D_PERF_TIMER(i2_ns);
+        // 1..4) N, k/N, granulés, passage, débit
+        const I2Flow fl = _i2_flow(m2, P);
+
+        // 5) Simulation de l’écoulement + glace (durée de vie)
+        // on échantillonne quelques grains seulement (pour debug/inspection)
+        std::vector<I2GrainSample> samples;
+        samples.reserve(std::max(0, std::min(fl.grains_total, P.sample_max)));
+        const I2Counts c = simulate_i2_grains(fl, P, [&](const I2GrainSample& g) {
+            if ((int)samples.size() < P.sample_max) samples.push_back(g);
+            });
+
+        I2Plan out = _i2_plan_from_counts(fl, c);
+        out.samples = std::move(samples);
+        T2D_PERF_ADD(i2_simulations, 1);
+        T2D_PERF_ADD(i2_grain_passes, 1);
+        T2D_PERF_ADD(grains, fl.grains_total);
+        T2D_PERF_ADD(i2_bytes, perf::bytes_of(out.samples));
+        return out;
+    }
+
+    // Chemin rapide “comptes seuls” : même simulation que generate_i2 (mêmes tirages, mêmes comptes,
+    // même somme), sans échantillons ni I2Plan — aucune allocation. Pour les boucles de recherche.
+    // Noyau scalaire/AVX2/AVX-512 choisi à l’exécution (time2d_i2_simd.h), résultats identiques au bit près.
+    inline I2Counts count_i2(const M2Plan& m2, const I2Params& P) {
+        const I2Flow fl = _i2_flow(m2, P);
+        simd::FlowArgs a;
+        a.seed = P.seed;
+        a.jitter = std::clamp(P.life_jitter, 0.0, 0.99); // cf. _jitter_factor
+        a.life_mean = P.life_mean;
+        a.service_time = fl.service_time;
+        a.grains_total = fl.grains_total;
+        const simd::FlowTally t = simd::flow_count(a);
+        T2D_PERF_ADD(i2_simulations, 1);
+        T2D_PERF_ADD(i2_grain_passes, 1);
+
+        I2Counts out;
+        out.grains_memorized = t.memorized;
+        out.grains_lost = fl.grains_total - t.memorized;
+        out.sum_finish_mem = t.sum_finish_mem;
+        return out;
+    }
+
+    // -----------------------------
+    // Évaluation multi-facteurs (une passe pour plusieurs life_mean)
+    // -----------------------------
+    // Équivalent à generate_i2 avec life_mean = max(1e-9, P.life_mean * factors[j]) pour chaque j,
+    // mais en UNE passe sur les grains : le jitter de chaque grain est tiré une seule fois et réutilisé
+    // pour tous les facteurs (boucle interne sans branche, vectorisable). out.size() >= factors.size().
+    // Les facteurs sont traités par blocs de 64 (pile uniquement, aucune allocation).
+    inline void generate_i2_factors(const M2Plan& m2, const I2Params& P,
+        std::span<const double> factors, std::span<I2Counts> out) {
+        constexpr size_t kBlock = 64;
+        const I2Flow fl = _i2_flow(m2, P);
+
+        for (size_t b = 0; b < factors.size(); b += kBlock) {
+            const size_t n = std::min(kBlock, factors.size() - b);
+            T2D_PERF_ADD(i2_simulations, n);
+            T2D_PERF_ADD(i2_grain_passes, 1);
+            double life_mean[kBlock], sum[kBlock];
+            int mem[kBlock];
+            for (size_t j = 0; j < n; ++j) {
+                life_mean[j] = std::max(1e-9, P.life_mean * factors[b + j]);
+                sum[j] = 0.0; mem[j] = 0;
+            }
+
+            t2d::LCG rng{ P.seed };
+            for (int i = 0; i < fl.grains_total; ++i) {
+                const double wait = (double)i * fl.service_time;
+                const double finish = wait + fl.service_time;
+                const double jit = _jitter_factor(P.life_jitter, rng);
+                for (size_t j = 0; j < n; ++j) {
+                    const bool ok = (life_mean[j] * jit >= finish);
+                    mem[j] += ok ? 1 : 0;
+                    sum[j] += ok ? finish : 0.0;  // x + 0.0 == x : somme identique à generate_i2
+                }
+            }
+
+            for (size_t j = 0; j < n; ++j) {
+                out[b + j].grains_memorized = mem[j];
+                out[b + j].grains_lost = fl.grains_total - mem[j];
+                out[b + j].sum_finish_mem = sum[j];
+            }
+        }
+    }
+
+    inline std::vector<I2Counts> generate_i2_factors(const M2Plan& m2, const I2Params& P,
+        std::span<const double> factors) {
+        std::vector<I2Counts> out(factors.size());
+        generate_i2_factors(m2, P, factors, out);
+        return out;
+    }
+
+    // -----------------------------
+    // Seuils critiques sur life_mean (facteur f)
+    // -----------------------------
+    // Un grain i est mémorisé ssi max(1e-9, life_mean*f) * jitter_i >= finish_i ; le jitter ne dépend
+    // pas de f, le prédicat est donc monotone en f. Le seuil du grain est le PLUS PETIT double f
+    // qui le rend mémorisé (même arithmétique que generate_i2, donc exact au bit près) :
+    //   memorized(f) == #{ i : seuil_i <= f }   pour tout f >= 0.
+    // 0 => mémorisé pour tout f ; +inf => jamais mémorisé.
+    inline double _i2_grain_threshold(double life_mean, double jitter, double finish) {
+        auto ok = [&](double f) { return std::max(1e-9, life_mean * f) * jitter >= finish; };
+        constexpr double kMax = std::numeric_limits<double>::max();
+        if (ok(0.0)) return 0.0;
+        if (!ok(kMax)) return std::numeric_limits<double>::infinity();
+
+        // f > 0 : l’ordre des doubles positifs est celui de leur représentation binaire
+        auto bits = [](double f) { return std::bit_cast<uint64_t>(f); };
+        auto real = [](uint64_t b) { return std::bit_cast<double>(b); };
+
+        // estimation analytique, puis correction à l’ulp près (ok(lo) == false, ok(hi) == true)
+        double guess = finish / (life_mean * jitter);
+        if (!(guess > 0.0) || guess > kMax) guess = kMax;
+        uint64_t lo = 0, hi = bits(kMax), g = bits(guess);
+        for (uint64_t d = 1; hi - lo > 1; d <<= 1) {
+            if (ok(real(g))) {
+                hi = g;
+                const uint64_t t = (g - lo > d) ? g - d : lo;
+                if (t == lo || !ok(real(t))) { lo = t; break; }
+                g = t;
             }
+            else {
+                lo = g;
+                const uint64_t t = (hi - g > d) ? g + d : hi;
+                if (t == hi || ok(real(t))) { hi = t; break; }
+                g = t;
+            }
+        }
+        while (hi - lo > 1) {
+            const uint64_t mid = lo + (hi - lo) / 2;
+            if (ok(real(mid))) hi = mid; else lo = mid;
+        }
+        return real(hi);
+    }
+
+    // Tire les jitters UNE fois (même seed/ordre que generate_i2) et remplit `out` avec le seuil
+    // critique de chaque grain (out.size() == grains_total, ordre des grains).
+    inline void i2_critical_factors(const M2Plan& m2, const I2Params& P, std::vector<double>& out) {
+        const I2Flow fl = _i2_flow(m2, P);
+        out.resize((size_t)fl.grains_total);
+        T2D_PERF_ADD(i2_grain_passes, 1);
+
+        t2d::LCG rng{ P.seed };
+        for (int i = 0; i < fl.grains_total; ++i) {
+            const double wait = (double)i * fl.service_time;
+            const double finish = wait + fl.service_time;
+            out[(size_t)i] = _i2_grain_threshold(P.life_mean, _jitter_factor(P.life_jitter, rng), finish);
+        }
+    }
+
+    // -----------------------------
+    // i2 multi-thread (plages de grains)
+    // -----------------------------
+    // [0, grains_total) est découpé en blocs de `chunk` grains (taille FIXE, indépendante du nombre
+    // de threads) ; chaque bloc démarre son flux de jitter au bon décalage (LCG::at) et calcule ses
+    // comptes locaux, fusionnés ensuite dans l’ordre des blocs. Comptes et échantillons identiques à
+    // generate_i2 ; mean_finish_time ne dépend que de `chunk` (somme par blocs : peut différer de
+    // generate_i2 au dernier ulp dès qu’il y a plus d’un bloc).
+    inline I2Plan generate_i2_parallel(const M2Plan& m2, const I2Params& P,
+        ThreadPool& pool = ThreadPool::shared(), int chunk = 1 << 16) {
+        T2D_PERF_TIMER(i2_ns);
+        const I2Flow fl = _i2_flow(m2, P);
+        I2Plan out = _i2_plan_from_flow(fl);
+        chunk = std::max(1, chunk);
+
+        simd::FlowArgs base;
+        base.jitter = std::clamp(P.life_jitter, 0.0, 0.99); // cf. _jitter_factor
+        base.life_mean = P.life_mean;
+        base.service_time = fl.service_time;
+
+        const size_t chunks = ((size_t)fl.grains_total + (size_t)chunk - 1) / (size_t)chunk;
+        std::vector<simd::FlowTally> part(chunks);
+        pool.parallel_for(chunks, [&](size_t c) {
+            simd::FlowArgs a = base;
+            a.first = (int)(c * (size_t)chunk);
+            a.grains_total = (int)std::min((size_t)fl.grains_total, (size_t)a.first + (size_t)chunk);
+            a.seed = t2d::LCG::at(P.seed, (uint64_t)a.first).s;
+            part[c] = simd::flow_count(a);
+            });
+
+        // fusion déterministe (ordre des blocs)
+        int mem = 0;
+        double sum_finish_mem = 0.0;
+        for (const auto& t : part) { mem += t.memorized; sum_finish_mem += t.sum_finish_mem; }
+
+        // échantillon : les sample_max premiers grains, comme generate_i2
+        const int ns = std::max(0, std::min(fl.grains_total, P.sample_max));
+        out.samples.reserve(ns);
+        t2d::LCG rng{ P.seed };
+        for (int i = 0; i < ns; ++i) {
+            const double wait = (double)i * fl.service_time;
+            const double finish = wait + fl.service_time;
+            const double life = P.life_mean * _jitter_factor(P.life_jitter, rng);
+            out.samples.push_back(I2GrainSample{
+              .id = i,
+              .life = life,
+              .wait_time = wait,
+              .pass_time = fl.service_time,
+              .finish_time = finish,
+              .memorized = (life >= finish)
+                });
         }
 
         out.grains_memorized = mem;
-        out.grains_lost = lost;
+        out.grains_lost = fl.grains_total - mem;
         out.rate_memorized = (double)mem / (double)out.grains_total;
         out.mean_finish_time = (mem > 0) ? (sum_finish_mem / (double)mem) : 0.0;
-
+        T2D_PERF_ADD(i2_simulations, 1);
+        T2D_PERF_ADD(i2_grain_passes, 1);
+        T2D_PERF_ADD(grains, fl.grains_total);
+        T2D_PERF_ADD(i2_bytes, perf::bytes_of(out.samples));
         return out;
     }
 
@@ -0,0 +1,131 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+
+namespace t2d {
+
+    // -----------------------------
+    // Cache LRU borné des simulations I2 (thread-safe)
+    // -----------------------------
+    // generate_i2 ne lit du M2Plan que replicas_effective : la clé est donc
+    // (replicas_effective, I2Params effectifs avec life_mean = max(1e-9, life_mean * f)).
+    // Comparaison exacte des champs (doubles bit à bit) : un hit rend exactement le plan qu’aurait
+    // produit generate_i2. Sur un miss, la simulation tourne hors verrou.
+    class I2Cache {
+    public:
+        struct Stats {
+            uint64_t hits{ 0 }, misses{ 0 }, evictions{ 0 };
+            size_t   size{ 0 }, capacity{ 0 };
+        };
+
+        explicit I2Cache(size_t capacity = 256) : capacity_(std::max<size_t>(1, capacity)) {}
+
+        I2Cache(const I2Cache&) = delete;
+        I2Cache& operator=(const I2Cache&) = delete;
+
+        // cache partagé du processus
+        static I2Cache& shared() { static I2Cache cache; return cache; }
+
+        // équivalent à generate_i2(m2, P avec life_mean = max(1e-9, P.life_mean * factor))
+        std::shared_ptr<const I2Plan> simulate(const M2Plan& m2, const I2Params& P, double factor = 1.0) {
+            I2Params ip = P;
+            ip.life_mean = std::max(1e-9, P.life_mean * factor);
+            const Key key = make_key(m2, ip);
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = index_.find(key);
+                if (it != index_.end()) {
+                    lru_.splice(lru_.begin(), lru_, it->second);
+                    ++hits_;
+                    return it->second->second;
+                }
+                ++misses_;
+            }
+
+            auto plan = std::make_shared<const I2Plan>(generate_i2(m2, ip));
+
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = index_.find(key);
+            if (it != index_.end()) {                   // calculé entre-temps par un autre thread
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return it->second->second;
+            }
+            lru_.emplace_front(key, plan);
+            index_.emplace(key, lru_.begin());
+            while (lru_.size() > capacity_) {
+                index_.erase(lru_.back().first);
+                lru_.pop_back();
+                ++evictions_;
+            }
+            return plan;
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lk(m_);
+            lru_.clear(); index_.clear();
+        }
+
+        void set_capacity(size_t capacity) {
+            std::lock_guard<std::mutex> lk(m_);
+            capacity_ = std::max<size_t>(1, capacity);
+            while (lru_.size() > capacity_) {
+                index_.erase(lru_.back().first);
+                lru_.pop_back();
+                ++evictions_;
+            }
+        }
+
+        Stats stats() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return { hits_, misses_, evictions_, lru_.size(), capacity_ };
+        }
+
+    private:
+        struct Key {
+            uint64_t w[9]{};
+            bool operator==(const Key& o) const { return std::equal(w, w + 9, o.w); }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& k) const {
+                uint64_t h = 0x9e3779b97f4a7c15ULL;
+                for (uint64_t x : k.w) {
+                    h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+                    h = (h ^ (h >> 31)) * 0xbf58476d1ce4e5b9ULL;
+                }
+                return (size_t)h;
+            }
+        };
+
+        static Key make_key(const M2Plan& m2, const I2Params& p) {
+            Key k;
+            k.w[0] = (uint64_t)(uint32_t)m2.replicas_effective;
+            k.w[1] = (uint64_t)(uint32_t)p.total_vertices_n;
+            k.w[2] = std::bit_cast<uint64_t>(p.inverse_ratio);
+            k.w[3] = (uint64_t)(uint32_t)p.iterations_inherited;
+            k.w[4] = std::bit_cast<uint64_t>(p.force_rate);
+            k.w[5] = std::bit_cast<uint64_t>(p.life_mean);
+            k.w[6] = std::bit_cast<uint64_t>(p.life_jitter);
+            k.w[7] = (uint64_t)(uint32_t)p.sample_max;
+            k.w[8] = p.seed;
+            return k;
+        }
+
+        using Entry = std::pair<Key, std::shared_ptr<const I2Plan>>;
+
+        mutable std::mutex m_;
+        std::list<Entry> lru_;                                             // tête = plus récent
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+        size_t   capacity_;
+        uint64_t hits_{ 0 }, misses_{ 0 }, evictions_{ 0 };
+    };
+
+} // namespace t2d
@@ -0,0 +1,250 @@
+﻿#pragma once
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include "time2d_m2.h"   // LCG
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define T2D_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Attribut de cible par fonction (GCC/Clang) ; MSVC compile les intrinsèques sans attribut.
+#if defined(T2D_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define T2D_TARGET(isa) __attribute__((target(isa)))
+#else
+#define T2D_TARGET(isa)
+#endif
+
+namespace t2d {
+    namespace simd {
+
+        // -----------------------------
+        // Noyau de l’écoulement i2 (comptes seuls) : scalaire / AVX2 / AVX-512, choisi à l’exécution
+        // -----------------------------
+        // Les noyaux vectoriels reproduisent le scalaire AU BIT PRÈS (mêmes comptes, même somme) :
+        // - jitter multi-voies déterministe : la voie l démarre à l’état s_{l+1} de la LCG et avance
+        //   de L pas à chaque bloc (composition affine a^L, c_L) ;
+        // - mêmes opérations flottantes, sans FMA (AVX2 ciblé sans "fma", AVX-512 en arrondi explicite) ;
+        // - somme des finish des mémorisés accumulée dans l’ordre des grains.
+        // Le code scalaire ne doit pas être contracté en FMA non plus : sur GCC/Clang avec FMA activé
+        // (-mfma, -march=...), seul le scalaire est retenu, sauf si la build définit T2D_NO_FP_CONTRACT
+        // (compilée avec -ffp-contract=off). MSVC (/fp:precise) ne contracte pas.
+
+        enum class Isa { Scalar, Avx2, Avx512 };
+
+        // Grains traités : [first, grains_total). `seed` est l’état LCG AVANT le grain `first`
+        // (LCG::at(seed_i2, first).s) : un bloc reproduit exactement sa part du flux séquentiel.
+        struct FlowArgs {
+            uint64_t seed{};
+            double   jitter{};        // déjà borné [0, 0.99]
+            double   life_mean{};
+            double   service_time{};
+            int      grains_total{};
+            int      first{ 0 };
+        };
+
+        struct FlowTally {
+            int    memorized{};
+            double sum_finish_mem{};
+        };
+
+        // un grain : même arithmétique que generate_i2 (s = état LCG APRÈS le tirage du grain)
+        inline void _flow_grain(FlowTally& t, const FlowArgs& a, int i, uint64_t s) {
+            const double u = ((double)(uint32_t)(s >> 32) + 0.5) / 4294967296.0;
+            const double f = std::max(0.0, 1.0 + (2.0 * u - 1.0) * a.jitter);
+            const double life = a.life_mean * f;
+            const double wait = (double)i * a.service_time;
+            const double finish = wait + a.service_time;
+            if (life >= finish) { ++t.memorized; t.sum_finish_mem += finish; }
+        }
+
+        inline FlowTally flow_count_scalar(const FlowArgs& a) {
+            FlowTally t;
+            t2d::LCG rng{ a.seed };
+            for (int i = a.first; i < a.grains_total; ++i) { rng.next(); _flow_grain(t, a, i, rng.s); }
+            return t;
+        }
+
+#if defined(T2D_SIMD_X86)
+        T2D_TARGET("avx2")
+        inline __m256i _mullo64_avx2(__m256i x, __m256i y) {
+            const __m256i lolo = _mm256_mul_epu32(x, y);
+            const __m256i hilo = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), y);
+            const __m256i lohi = _mm256_mul_epu32(x, _mm256_srli_epi64(y, 32));
+            return _mm256_add_epi64(lolo, _mm256_slli_epi64(_mm256_add_epi64(hilo, lohi), 32));
+        }
+
+        T2D_TARGET("avx2")
+        inline int _flow_blocks_avx2(const FlowArgs& a, FlowTally& t, uint64_t* lane) {
+            constexpr int L = 4;
+
+            t2d::LCG rng{ a.seed };
+            for (int l = 0; l < L; ++l) { rng.next(); lane[l] = rng.s; }
+            constexpr LCG::Affine jump = LCG::jump(L);
+
+            __m256i s = _mm256_loadu_si256((const __m256i*)lane);
+            const __m256i mulL = _mm256_set1_epi64x((long long)jump.mul);
+            const __m256i addL = _mm256_set1_epi64x((long long)jump.add);
+            const __m256i magic_i = _mm256_set1_epi64x(0x4330000000000000LL); // 2^52 : u32 -> double exact
+            const __m256d magic_d = _mm256_set1_pd(4503599627370496.0);
+            const __m256d half = _mm256_set1_pd(0.5), inv32 = _mm256_set1_pd(1.0 / 4294967296.0);
+            const __m256d one = _mm256_set1_pd(1.0), two = _mm256_set1_pd(2.0), zero = _mm256_setzero_pd();
+            const __m256d jit = _mm256_set1_pd(a.jitter), lm = _mm256_set1_pd(a.life_mean);
+            const __m256d svc = _mm256_set1_pd(a.service_time), stepL = _mm256_set1_pd((double)L);
+            const double i0 = (double)a.first;
+            __m256d idx = _mm256_set_pd(i0 + 3.0, i0 + 2.0, i0 + 1.0, i0);
+
+            int i = a.first;
+            for (; i + L <= a.grains_total; i += L) {
+                const __m256i hi = _mm256_or_si256(_mm256_srli_epi64(s, 32), magic_i);
+                const __m256d x = _mm256_sub_pd(_mm256_castsi256_pd(hi), magic_d);
+                const __m256d u = _mm256_mul_pd(_mm256_add_pd(x, half), inv32);
+                __m256d f = _mm256_add_pd(one, _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(two, u), one), jit));
+                f = _mm256_max_pd(f, zero);                 // == std::max(0.0, f)
+                const __m256d life = _mm256_mul_pd(lm, f);
+                const __m256d finish = _mm256_add_pd(_mm256_mul_pd(idx, svc), svc);
+
+                const unsigned m = (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(life, finish, _CMP_GE_OQ));
+                if (m) {
+                    alignas(32) double fin[L];
+                    _mm256_store_pd(fin, finish);
+                    t.memorized += std::popcount(m);
+                    if (m == 0xFu) for (int l = 0; l < L; ++l) t.sum_finish_mem += fin[l];
+                    else for (int l = 0; l < L; ++l) if (m & (1u << l)) t.sum_finish_mem += fin[l];
+                }
+                s = _mm256_add_epi64(_mullo64_avx2(s, mulL), addL);
+                idx = _mm256_add_pd(idx, stepL);
+            }
+
+            _mm256_storeu_si256((__m256i*)lane, s);
+            return i;
+        }
+
+#define T2D_RN (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // faux positif des en-têtes AVX-512 de GCC
+#endif
+        T2D_TARGET("avx512f,avx512dq")
+        inline int _flow_blocks_avx512(const FlowArgs& a, FlowTally& t, uint64_t* lane) {
+            constexpr int L = 8;
+
+            t2d::LCG rng{ a.seed };
+            for (int l = 0; l < L; ++l) { rng.next(); lane[l] = rng.s; }
+            constexpr LCG::Affine jump = LCG::jump(L);
+
+            __m512i s = _mm512_loadu_si512((const void*)lane);
+            const __m512i mulL = _mm512_set1_epi64((long long)jump.mul);
+            const __m512i addL = _mm512_set1_epi64((long long)jump.add);
+            const __m512d half = _mm512_set1_pd(0.5), inv32 = _mm512_set1_pd(1.0 / 4294967296.0);
+            const __m512d one = _mm512_set1_pd(1.0), two = _mm512_set1_pd(2.0), zero = _mm512_setzero_pd();
+            const __m512d jit = _mm512_set1_pd(a.jitter), lm = _mm512_set1_pd(a.life_mean);
+            const __m512d svc = _mm512_set1_pd(a.service_time), stepL = _mm512_set1_pd((double)L);
+            const double i0 = (double)a.first;
+            __m512d idx = _mm512_set_pd(i0 + 7.0, i0 + 6.0, i0 + 5.0, i0 + 4.0, i0 + 3.0, i0 + 2.0, i0 + 1.0, i0);
+
+            // opérations *_round_pd : jamais fusionnées en FMA par le compilateur
+            int i = a.first;
+            for (; i + L <= a.grains_total; i += L) {
+                const __m512d x = _mm512_cvtepu64_pd(_mm512_srli_epi64(s, 32));
+                const __m512d u = _mm512_mul_round_pd(_mm512_add_round_pd(x, half, T2D_RN), inv32, T2D_RN);
+                const __m512d d = _mm512_sub_round_pd(_mm512_mul_round_pd(two, u, T2D_RN), one, T2D_RN);
+                __m512d f = _mm512_add_round_pd(one, _mm512_mul_round_pd(d, jit, T2D_RN), T2D_RN);
+                f = _mm512_max_pd(f, zero);
+                const __m512d life = _mm512_mul_round_pd(lm, f, T2D_RN);
+                const __m512d finish = _mm512_add_round_pd(_mm512_mul_round_pd(idx, svc, T2D_RN), svc, T2D_RN);
+
+                const unsigned m = (unsigned)_mm512_cmp_pd_mask(life, finish, _CMP_GE_OQ);
+                if (m) {
+                    alignas(64) double fin[L];
+                    _mm512_store_pd(fin, finish);
+                    t.memorized += std::popcount(m);
+                    if (m == 0xFFu) for (int l = 0; l < L; ++l) t.sum_finish_mem += fin[l];
+                    else for (int l = 0; l < L; ++l) if (m & (1u << l)) t.sum_finish_mem += fin[l];
+                }
+                s = _mm512_add_epi64(_mm512_mullo_epi64(s, mulL), addL);
+                idx = _mm512_add_round_pd(idx, stepL, T2D_RN);
+            }
+
+            _mm512_storeu_si512((void*)lane, s);
+            return i;
+        }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#undef T2D_RN
+
+        // Les blocs vectoriels laissent dans `lane` l’état LCG des grains restants (< L) ; la queue est
+        // traitée ici, hors des fonctions ciblées (le compilateur pourrait y contracter le scalaire en FMA).
+        inline FlowTally _flow_tail(const FlowArgs& a, FlowTally t, int i, const uint64_t* lane) {
+            for (int l = 0; i < a.grains_total; ++i, ++l) _flow_grain(t, a, i, lane[l]);
+            return t;
+        }
+
+        inline FlowTally flow_count_avx2(const FlowArgs& a) {
+            FlowTally t;
+            uint64_t lane[4];
+            const int i = _flow_blocks_avx2(a, t, lane);
+            return _flow_tail(a, t, i, lane);
+        }
+
+        inline FlowTally flow_count_avx512(const FlowArgs& a) {
+            FlowTally t;
+            uint64_t lane[8];
+            const int i = _flow_blocks_avx512(a, t, lane);
+            return _flow_tail(a, t, i, lane);
+        }
+#endif // T2D_SIMD_X86
+
+        // -----------------------------
+        // Détection du jeu d’instructions (une fois par processus)
+        // -----------------------------
+        inline Isa _detect_isa() {
+#if defined(T2D_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+            int r[4];
+            __cpuid(r, 0);
+            if (r[0] < 7) return Isa::Scalar;
+            __cpuid(r, 1);
+            const bool osxsave = (r[2] & (1 << 27)) != 0, avx = (r[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx) return Isa::Scalar;
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(r, 7, 0);
+            const bool avx2 = (r[1] & (1 << 5)) != 0;
+            const bool avx512 = (r[1] & (1 << 16)) != 0 && (r[1] & (1 << 17)) != 0; // F + DQ
+            if (avx512 && (xcr0 & 0xE6) == 0xE6) return Isa::Avx512;
+            if (avx2 && (xcr0 & 0x6) == 0x6) return Isa::Avx2;
+#else
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return Isa::Avx512;
+            if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+#endif
+#endif
+            return Isa::Scalar;
+        }
+
+        // meilleur noyau sûr pour ce processus (voir la note sur la contraction FMA ci-dessus)
+        inline Isa best_isa() {
+#if !defined(_MSC_VER) && defined(__FMA__) && !defined(T2D_NO_FP_CONTRACT)
+            return Isa::Scalar;
+#else
+            static const Isa isa = _detect_isa();
+            return isa;
+#endif
+        }
+
+        inline FlowTally flow_count(const FlowArgs& a, Isa isa = best_isa()) {
+#if defined(T2D_SIMD_X86)
+            if (isa == Isa::Avx512) return flow_count_avx512(a);
+            if (isa == Isa::Avx2) return flow_count_avx2(a);
+#endif
+            (void)isa;
+            return flow_count_scalar(a);
+        }
+
+    } // namespace simd
+} // namespace t2d
@@ -49,6 +49,10 @@ namespace t2d {
             static constexpr int MAX_ITERATION = 4;
             static constexpr int MAX_THEORETICAL_VERTICES_R4 = 37448; // 8 + 8*(8+8^2+8^3+8^4)
             static constexpr int RECOMMENDED_N_CAP_DEV = 12000;       // cap pratique conseillé
+
+            // Génération en flux (RandomGenPolyShape::generate_stream, r max = 8)
+            static constexpr int MAX_STREAM_ITERATION = 8;
+            static constexpr long long MAX_THEORETICAL_VERTICES_R8 = 153391688LL; // 8 + 8*(8+...+8^8)
         };
 
         inline Inputs sanitize(const Inputs& in, const Limits& lim = {}) {
@@ -170,6 +174,35 @@ namespace t2d {
             int    readable_effective{ 0 }; // combien “lisibles” dans CONTAINER_TIME_READ (partie centrale)
         };
 
+#if defined(T2D_ENABLE_PERF_COUNTERS)
+        // Coût du calcul (cf. time2d_perf.h) : absent si T2D_ENABLE_PERF_COUNTERS n’est pas défini
+        struct PerfCounters {
+            // temps mur par étage (ns)
+            uint64_t shape_ns{ 0 };
+            uint64_t m2_ns{ 0 };
+            uint64_t i2_ns{ 0 };
+            uint64_t macros_ns{ 0 };
+
+            // I2 : simulations évaluées (un facteur = une simulation), passes sur les grains
+            uint64_t i2_simulations{ 0 };
+            uint64_t i2_grain_passes{ 0 };
+            uint64_t macros_i2_simulations{ 0 };  // part de compute_macros
+            uint64_t bisection_iterations{ 0 };   // étapes de dichotomie (repli)
+            uint64_t exact_quantiles{ 0 };        // facteurs obtenus par statistique d’ordre
+
+            // volumes produits
+            uint64_t vertices{ 0 };
+            uint64_t events{ 0 };
+            uint64_t grains{ 0 };
+
+            // octets alloués pour les sorties de chaque étage (croissance de capacité)
+            uint64_t shape_bytes{ 0 };
+            uint64_t m2_bytes{ 0 };
+            uint64_t i2_bytes{ 0 };
+            uint64_t macros_bytes{ 0 };           // tampon de seuils de compute_macros
+        };
+#endif
+
         struct Outputs {
             std::string       version{ Version::tag };
             Counters          counters{};
@@ -180,6 +213,9 @@ namespace t2d {
             TimeBudget        time_budget{};
             Projection        projection_high{};
             std::vector<std::string> notes;
+#if defined(T2D_ENABLE_PERF_COUNTERS)
+            PerfCounters      perf{};
+#endif
         };
 
     } // namespace iface
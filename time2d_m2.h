@@ -1,18 +1,52 @@
 ﻿#pragma once
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 #include <string>
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <limits>
+#include <initializer_list>
+#include "time2d_perf.h"   // compteurs par étage (vides sauf T2D_ENABLE_PERF_COUNTERS)
 
 namespace t2d {
 
     // ---------- RNG minimal, déterministe ----------
     struct LCG {
+        static constexpr uint64_t kMul = 2862933555777941757ULL;
+        static constexpr uint64_t kInc = 3037000493ULL;
+
         uint64_t s; explicit LCG(uint64_t seed = 0x9e3779b97f4a7c15ULL) : s(seed) {}
-        uint32_t next() { s = 2862933555777941757ULL * s + 3037000493ULL; return (uint32_t)(s >> 32); }
+        uint32_t next() { s = kMul * s + kInc; return (uint32_t)(s >> 32); }
         double uniform() { return (next() + 0.5) / 4294967296.0; } // [0,1)
+
+        // n pas composés en une transformation affine s -> mul*s + add (mod 2^64), en O(log n)
+        struct Affine { uint64_t mul{ 1 }, add{ 0 }; };
+        static constexpr Affine jump(uint64_t n) {
+            Affine r, b{ kMul, kInc };
+            for (; n; n >>= 1) {
+                if (n & 1) r = { b.mul * r.mul, b.mul * r.add + b.add };
+                b = { b.mul * b.mul, b.mul * b.add + b.add };
+            }
+            return r;
+        }
+
+        // saut en avant : équivaut à n appels à next()
+        void discard(uint64_t n) { const Affine j = jump(n); s = j.mul * s + j.add; }
+
+        // générateur positionné après n tirages depuis `seed` : un découpage [a,b) d’un flux
+        // séquentiel démarre à at(seed, a) et reproduit exactement les tirages a..b-1
+        static LCG at(uint64_t seed, uint64_t n) { LCG g{ seed }; g.discard(n); return g; }
+
+        // sous-flux indépendant n° `id` (graine dérivée par splitmix64 de (seed, id)) ;
+        // déterministe, ne dépend pas de l’ordre ni du nombre de sous-flux tirés
+        static LCG stream(uint64_t seed, uint64_t id) {
+            uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (id + 1);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return LCG{ z ^ (z >> 31) };
+        }
     };
 
     // ---------- Géométrie : forme initiale ----------
@@ -41,6 +75,60 @@ namespace t2d {
         int cluster{ -1 };   // id de cluster FOUDRE (si pertinent)
     };
 
+    // ---------- Evénements en colonnes (SoA) ----------
+    // tick : 8 o, op : 1 o, vertex / edge / cluster : 4 o -> un balayage sur tick / op ne lit que
+    // 9 o par événement (24 o en EventTick). Accès ligne par ligne via operator[] / itérateur (EventTick
+    // reconstruit par valeur). vertex / edge / cluster restent en int32 : -1 sert de sentinelle et les
+    // indices d’une Shape ne sont pas bornés à 16 bits (formes en flux, snapshots) ; largeur fixe =>
+    // colonnes lues telles quelles par l’export et le snapshot.
+    struct M2EventColumns {
+        std::vector<double>  tick;
+        std::vector<uint8_t> op;
+        std::vector<int32_t> vertex, edge, cluster;
+
+        size_t size() const { return tick.size(); }
+        bool   empty() const { return tick.empty(); }
+
+        void clear() { tick.clear(); op.clear(); vertex.clear(); edge.clear(); cluster.clear(); }
+        void reserve(size_t n) { tick.reserve(n); op.reserve(n); vertex.reserve(n); edge.reserve(n); cluster.reserve(n); }
+
+        void push_back(const EventTick& e) {
+            tick.push_back(e.tick); op.push_back((uint8_t)e.op);
+            vertex.push_back(e.vertex); edge.push_back(e.edge); cluster.push_back(e.cluster);
+        }
+
+        void assign(const std::vector<EventTick>& ev) {
+            const size_t n = ev.size();
+            tick.resize(n); op.resize(n); vertex.resize(n); edge.resize(n); cluster.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                tick[i] = ev[i].tick; op[i] = (uint8_t)ev[i].op;
+                vertex[i] = ev[i].vertex; edge[i] = ev[i].edge; cluster[i] = ev[i].cluster;
+            }
+        }
+
+        EventTick operator[](size_t i) const { return { tick[i], (Op)op[i], vertex[i], edge[i], cluster[i] }; }
+
+        struct const_iterator {
+            const M2EventColumns* c{ nullptr };
+            size_t i{ 0 };
+            using value_type = EventTick;
+            using difference_type = std::ptrdiff_t;
+            EventTick operator*() const { return (*c)[i]; }
+            const_iterator& operator++() { ++i; return *this; }
+            const_iterator operator++(int) { const_iterator t = *this; ++i; return t; }
+            bool operator==(const const_iterator& o) const { return i == o.i; }
+            bool operator!=(const const_iterator& o) const { return i != o.i; }
+        };
+        const_iterator begin() const { return { this, 0 }; }
+        const_iterator end()   const { return { this, size() }; }
+
+        std::vector<EventTick> to_events() const {
+            std::vector<EventTick> ev(size());
+            for (size_t i = 0; i < ev.size(); ++i) ev[i] = (*this)[i];
+            return ev;
+        }
+    };
+
     // ---------- Paramétrage M2 (sans granularité) ----------
     struct M2Params {
         // INIT
@@ -59,11 +147,15 @@ namespace t2d {
         // Clustering (regroupement statistique des instants FOUDRE)
         double cluster_percentile{ 0.25 }; // τ = percentile des gaps (réels)
         uint64_t seed{ 0xC0FFEEULL };
+
+        // Stockage : true -> M2Plan::columns rempli (SoA) et M2Plan::events laissé vide
+        bool   columnar_events{ false };
     };
 
     // ---------- Résultat ----------
     struct M2Plan {
-        std::vector<EventTick> events; // triés par tick croissant
+        std::vector<EventTick> events; // triés par tick croissant (vide si M2Params::columnar_events)
+        M2EventColumns columns;        // idem en colonnes (vide sinon)
         double tick_init_end{};        // dernier tick INIT (>=0)
         double tick_thunder_end{};     // dernier tick FOUDRE (>= tick_init_end)
         double tick_magmat_start{};    // premier tick MAGMAT (<= -epsilon)
@@ -72,6 +164,10 @@ namespace t2d {
         double thunder_min_gap{ 0.0 };   // plus petit écart mesuré entre deux instants FOUDRE
         double thunder_tau{ 1.0 };       // seuil de regroupement (τ) calculé
         int    replicas_effective{ 0 };  // k effectif utilisé (toujours < N)
+
+        // accès indépendant du stockage (AoS ou SoA)
+        size_t    event_count() const { return columns.empty() ? events.size() : columns.size(); }
+        EventTick event(size_t i) const { return columns.empty() ? events[i] : columns[i]; }
     };
 
     // ---------- utilitaires internes ----------
@@ -84,51 +180,116 @@ namespace t2d {
         return clampi(i, 0, n - 1);
     }
 
-    // ---------- génération principale ----------
-    inline M2Plan generate_m2(const Shape& S, const M2Params& P) {
-        M2Plan out;
-        out.events.reserve(P.init_span + P.thunder_span + P.magmat_span + 64);
+    // Tirage sans remise de K valeurs parmi [0, N), équivalent EXACT (mêmes tirages, même ordre) de
+    // « pool trié [0..N) ; j = floor(u * taille) ; pool.erase(pool.begin() + j) », sans pool de taille N :
+    // les valeurs retirées sont rangées dans un treap (clé, taille de sous-arbre) et la j-ième valeur
+    // libre est trouvée par descente. O(K log K) en temps, O(K) en mémoire.
+    inline void sample_distinct_ranked(LCG& rng, int N, int K, std::vector<int>& out) {
+        struct Node { int key, l, r, size; uint32_t pri; };
+        std::vector<Node> t; t.reserve((size_t)std::max(0, K));
+        auto sz = [&](int x) { return x < 0 ? 0 : t[(size_t)x].size; };
+        auto upd = [&](int x) { t[(size_t)x].size = 1 + sz(t[(size_t)x].l) + sz(t[(size_t)x].r); };
 
-        const int N = (int)S.V.size();
-        const int E = (int)S.E.size();
-        if (N == 0 || E == 0) return out;
+        // split(x) : clés < key à gauche, >= key à droite
+        auto split = [&](auto&& self, int x, int key, int& l, int& r) -> void {
+            if (x < 0) { l = r = -1; return; }
+            if (t[(size_t)x].key < key) { self(self, t[(size_t)x].r, key, t[(size_t)x].r, r); l = x; }
+            else { self(self, t[(size_t)x].l, key, l, t[(size_t)x].l); r = x; }
+            upd(x);
+        };
+        auto insert = [&](auto&& self, int x, int n) -> int {
+            if (x < 0) return n;
+            if (t[(size_t)n].pri > t[(size_t)x].pri) {
+                split(split, x, t[(size_t)n].key, t[(size_t)n].l, t[(size_t)n].r);
+                upd(n);
+                return n;
+            }
+            if (t[(size_t)n].key < t[(size_t)x].key) t[(size_t)x].l = self(self, t[(size_t)x].l, n);
+            else t[(size_t)x].r = self(self, t[(size_t)x].r, n);
+            upd(x);
+            return x;
+        };
 
-        // -------- PHASE 1 : INIT (ticks réels >= 0) --------
-        std::vector<int> order = S.draw_order.empty()
-            ? [&]() { std::vector<int> v(E); std::iota(v.begin(), v.end(), 0); return v; }()
-            : S.draw_order;
-
-        const int stepsI = (int)order.size();
-        for (int i = 0; i < stepsI; ++i) {
-            // réparti sur [0, init_span) en double
-            double t = (P.init_span > 0)
-                ? ((double)i / std::max(1, stepsI)) * (double)P.init_span
-                : 0.0;
-            out.events.push_back({ t, Op::InitTrace, -1, order[i], -1 });
-            out.tick_init_end = std::max(out.tick_init_end, t);
+        int root = -1;
+        for (int i = 0; i < K && i < N; ++i) {
+            const int j = (int)std::floor(rng.uniform() * (double)(N - i));
+
+            // plus petite valeur v libre avec #libres(< v) == j ; `before` = retirées < sous-arbre courant
+            int x = root, before = 0;
+            while (x >= 0) {
+                const int L = sz(t[(size_t)x].l);
+                if (j < t[(size_t)x].key - (before + L)) x = t[(size_t)x].l;
+                else { before += L + 1; x = t[(size_t)x].r; }
+            }
+            const int v = j + before;
+            out.push_back(v);
+
+            uint64_t h = (uint64_t)i * 0x9e3779b97f4a7c15ULL;
+            h = (h ^ (h >> 31)) * 0xbf58476d1ce4e5b9ULL;
+            t.push_back(Node{ v, -1, -1, 1, (uint32_t)(h >> 32) });
+            root = insert(insert, root, (int)t.size() - 1);
         }
-        out.events.push_back({ 0.0, Op::PhaseMark, -1, -1, -1 }); // INIT start
+    }
 
-        // -------- PHASE 2 : FOUDRE (ticks réels > tick_init_end) --------
-        const double thunder_start = out.tick_init_end + 1.0;
+    // ---------- ordre des événements : (tick, rang de l’op) ----------
+    inline int op_rank(Op op) {
+        static constexpr int rank[] = { 1, 2, 3, 4, 0 };   // InitTrace, ThunderBreak, ThunderReplica, MagmatHeal, PhaseMark
+        const unsigned i = (unsigned)op;
+        return i < 5 ? rank[i] : 5;
+    }
+    inline bool event_before(const EventTick& a, const EventTick& b) {
+        if (a.tick != b.tick) return a.tick < b.tick;
+        return op_rank(a.op) < op_rank(b.op);
+    }
+
+    // Runs consécutifs [bounds[i], bounds[i+1]) : chaque run n’est trié (stable) que s’il ne l’est pas déjà,
+    // puis fusionné au préfixe (inplace_merge, stable) seulement si leurs bornes se chevauchent.
+    // Linéaire quand les runs sont triés et disjoints (cas nominal de generate_m2).
+    inline void merge_event_runs(std::vector<EventTick>& ev, std::initializer_list<size_t> bounds) {
+        const size_t* bd = bounds.begin();
+        const size_t nb = bounds.size();
+        for (size_t k = 0; k + 1 < nb; ++k) {
+            const auto b0 = ev.begin() + (ptrdiff_t)bd[k], b1 = ev.begin() + (ptrdiff_t)bd[k + 1];
+            if (!std::is_sorted(b0, b1, event_before)) std::stable_sort(b0, b1, event_before);
+            if (k > 0 && b0 != b1 && bd[k] > 0 && event_before(*b0, *(b0 - 1)))
+                std::inplace_merge(ev.begin(), b0, b1, event_before);
+        }
+    }
+
+    // ---------- phases (partagées par generate_m2 et M2EventStepper) ----------
+    inline int _m2_replicas(int N, const M2Params& P) {
+        return std::min(std::max(0, P.replicas_k), std::max(0, N - 1)); // k < N
+    }
+
+    // INIT : réparti sur [0, init_span) en double (croissant en i)
+    inline double _m2_init_tick(int i, int steps, const M2Params& P) {
+        return (P.init_span > 0)
+            ? ((double)i / std::max(1, steps)) * (double)P.init_span
+            : 0.0;
+    }
+
+    // MAGMAT : réparti uniformément sur [-span .. 0[ (croissant en k), événement k = draw_order[steps-1-k]
+    inline double _m2_magmat_tick(int k, int steps, const M2Params& P) {
+        double tn = -(double)P.magmat_span + ((double)(k + 1) / (double)steps) * (double)P.magmat_span;
+        return std::min(tn, -std::numeric_limits<double>::epsilon());
+    }
+
+    // FOUDRE : PhaseMark + ruptures / répliques ajoutées à `ev` dans l’ordre d’émission (presque trié) ;
+    // renseigne replicas_effective, thunder_min_gap, thunder_tau, tick_thunder_end. Etat O(K).
+    inline void _m2_thunder_phase(int N, const M2Params& P, double thunder_start, M2Plan& out, std::vector<EventTick>& ev) {
         const double thunder_end = thunder_start + std::max(1, P.thunder_span);
-        out.events.push_back({ thunder_start, Op::PhaseMark, -1, -1, -1 }); // THUNDER start
+        ev.push_back({ thunder_start, Op::PhaseMark, -1, -1, -1 }); // THUNDER start
 
         LCG rng{ P.seed };
-        const int K = std::min(std::max(0, P.replicas_k), std::max(0, N - 1)); // k < N
+        const int K = _m2_replicas(N, P);
         out.replicas_effective = K;
 
         // tirage sans remise de K sommets distincts
         std::vector<int> chosen_vertices; chosen_vertices.reserve(K);
-        std::vector<int> pool(N); std::iota(pool.begin(), pool.end(), 0);
-        for (int i = 0; i < K && !pool.empty(); ++i) {
-            int j = (int)std::floor(rng.uniform() * (double)pool.size());
-            chosen_vertices.push_back(pool[j]);
-            pool.erase(pool.begin() + j);
-        }
+        sample_distinct_ranked(rng, N, K, chosen_vertices);
 
-        // instants réels avec jitter réel
-        std::vector<double> thunder_times; thunder_times.reserve(K);
+        // instants réels avec jitter réel ; [K, 2K-1) sert ensuite de tampon pour les gaps
+        std::vector<double> thunder_times; thunder_times.reserve(K > 0 ? 2 * (size_t)K - 1 : 0);
         for (int i = 0; i < K; ++i) {
             double base = thunder_start + rng.uniform() * std::max(1, P.thunder_span);
             double jitter = (rng.uniform() * 2.0 - 1.0) * P.thunder_jitter;
@@ -136,15 +297,22 @@ namespace t2d {
             thunder_times.push_back(tt);
         }
 
-        // τ : percentile des gaps réels
+        // τ : percentile des gaps réels (sélection, pas de tri complet des gaps)
         std::sort(thunder_times.begin(), thunder_times.end());
-        std::vector<double> gaps;
-        for (size_t i = 1; i < thunder_times.size(); ++i) gaps.push_back(thunder_times[i] - thunder_times[i - 1]);
         double tau = 1.0;
-        if (!gaps.empty()) {
-            std::sort(gaps.begin(), gaps.end());
-            tau = std::max(1.0, gaps[percentile_index((int)gaps.size(), P.cluster_percentile)]);
-            out.thunder_min_gap = gaps.front();
+        if (K > 1) {
+            double min_gap = std::numeric_limits<double>::infinity();
+            for (int i = 1; i < K; ++i) {
+                const double g = thunder_times[(size_t)i] - thunder_times[(size_t)i - 1];
+                thunder_times.push_back(g);   // dans la capacité réservée : pas de réallocation
+                min_gap = std::min(min_gap, g);
+            }
+            const auto gaps = thunder_times.begin() + K;
+            const auto nth = gaps + percentile_index(K - 1, P.cluster_percentile);
+            std::nth_element(gaps, nth, thunder_times.end());
+            tau = std::max(1.0, *nth);
+            thunder_times.resize((size_t)K);
+            out.thunder_min_gap = min_gap;
         }
         else {
             out.thunder_min_gap = 0.0;
@@ -157,46 +325,161 @@ namespace t2d {
             if (i > 0 && (thunder_times[i] - thunder_times[i - 1]) > tau) ++cluster_id;
             double t = thunder_times[i];
             int    v = chosen_vertices[i];
-            out.events.push_back({ t, Op::ThunderBreak, v, -1, cluster_id });
+            ev.push_back({ t, Op::ThunderBreak, v, -1, cluster_id });
 
             // éventuelle réplique quasi-instantanée (même t ou +ε)
             if (rng.uniform() < P.replica_rate) {
                 double eps = (rng.uniform() < 0.5 ? 0.0 : std::max(1e-6, 0.01 * tau)); // petit décalage
                 double t2 = clampd(t + eps, thunder_start, thunder_end - std::numeric_limits<double>::epsilon());
-                out.events.push_back({ t2, Op::ThunderReplica, v, -1, cluster_id });
+                ev.push_back({ t2, Op::ThunderReplica, v, -1, cluster_id });
             }
         }
         out.tick_thunder_end = thunder_end;
 
-        // -------- PHASE 3 : MAGMAT (ticks réels < 0) --------
-        std::reverse(order.begin(), order.end());
+    }
+
+    // ---------- générateur paresseux (pull) ----------
+    // Produit les événements de generate_m2(S, P) un par un, dans le même ordre, sans les matérialiser :
+    // INIT et MAGMAT sont calculés à la volée depuis leur indice, seule la FOUDRE est pré-calculée (O(K)).
+    // Fusion de 5 flux triés (marque MAGMAT, soins MAGMAT, marque INIT, tracés INIT, FOUDRE) ; à égalité
+    // (tick, op), le flux de rang le plus bas passe d’abord — comme la fusion stable de generate_m2.
+    // `S` doit survivre au stepper ; plan() porte les métriques (events vide).
+    class M2EventStepper {
+    public:
+        M2EventStepper(const Shape& S, const M2Params& P) : S_(S), P_(P) {
+            const int N = (int)S.V.size();
+            const int E = (int)S.E.size();
+            if (N == 0 || E == 0) { done_ = true; return; }
+            steps_ = S.draw_order.empty() ? E : (int)S.draw_order.size();
+
+            // tick_init_end = max(0, dernier tick INIT) (ticks INIT croissants)
+            if (steps_ > 0) plan_.tick_init_end = std::max(0.0, _m2_init_tick(steps_ - 1, steps_, P));
+            plan_.tick_magmat_start = -(double)P.magmat_span;
+
+            thunder_.reserve(2 * (size_t)_m2_replicas(N, P) + 1);
+            _m2_thunder_phase(N, P, plan_.tick_init_end + 1.0, plan_, thunder_);
+            if (!std::is_sorted(thunder_.begin(), thunder_.end(), event_before))
+                std::stable_sort(thunder_.begin(), thunder_.end(), event_before);
+        }
+
+        const M2Plan& plan() const { return plan_; }
+
+        // nombre total d’événements produits par next()
+        size_t size() const { return steps_ == 0 ? 0 : 2 * (size_t)steps_ + 2 + thunder_.size(); }
+
+        // false quand tous les événements ont été produits
+        bool next(EventTick& e) {
+            if (done_) return false;
+            int best = -1;
+            EventTick cand, head;
+            for (int s = 0; s < kStreams; ++s) {
+                if (!peek(s, cand)) continue;
+                if (best < 0 || event_before(cand, head)) { best = s; head = cand; }
+            }
+            if (best < 0) { done_ = true; return false; }
+            ++pos_[best];
+            e = head;
+            return true;
+        }
+
+    private:
+        enum { MagmatMark, MagmatHeal, InitMark, InitTrace, Thunder, kStreams };
+
+        int order(int i) const { return S_.draw_order.empty() ? i : S_.draw_order[(size_t)i]; }
+
+        bool peek(int s, EventTick& e) const {
+            const size_t i = pos_[s];
+            switch (s) {
+            case MagmatMark:
+                if (i >= 1) return false;
+                e = { plan_.tick_magmat_start, Op::PhaseMark, -1, -1, -1 }; return true;
+            case MagmatHeal:
+                if (i >= (size_t)steps_) return false;
+                e = { _m2_magmat_tick((int)i, steps_, P_), Op::MagmatHeal, -1, order(steps_ - 1 - (int)i), -1 }; return true;
+            case InitMark:
+                if (i >= 1) return false;
+                e = { 0.0, Op::PhaseMark, -1, -1, -1 }; return true;
+            case InitTrace:
+                if (i >= (size_t)steps_) return false;
+                e = { _m2_init_tick((int)i, steps_, P_), Op::InitTrace, -1, order((int)i), -1 }; return true;
+            default:
+                if (i >= thunder_.size()) return false;
+                e = thunder_[i]; return true;
+            }
+        }
+
+        const Shape& S_;
+        M2Params P_;
+        M2Plan plan_;
+        std::vector<EventTick> thunder_;
+        int steps_{ 0 };
+        size_t pos_[kStreams]{};
+        bool done_{ false };
+    };
+
+    inline void _m2_perf_account([[maybe_unused]] const M2Plan& out) {
+        T2D_PERF_ADD(events, out.event_count());
+        T2D_PERF_ADD(m2_bytes, perf::bytes_of(out.events) + perf::bytes_of(out.columns.tick) + perf::bytes_of(out.columns.op)
+            + perf::bytes_of(out.columns.vertex) + perf::bytes_of(out.columns.edge) + perf::bytes_of(out.columns.cluster));
+    }
+
+    // ---------- génération principale ----------
+    inline M2Plan generate_m2(const Shape& S, const M2Params& P) {
+        T2D_PERF_TIMER(m2_ns);
+        M2Plan out;
+
+        const int N = (int)S.V.size();
+        const int E = (int)S.E.size();
+        if (N == 0 || E == 0) return out;
+
+        // SoA : colonnes remplies directement dans l’ordre final par le stepper (mêmes événements),
+        // sans tableau EventTick intermédiaire => pic mémoire = colonnes + FOUDRE (O(K))
+        if (P.columnar_events) {
+            M2EventStepper st(S, P);
+            out = st.plan();
+            out.columns.reserve(st.size());
+            for (EventTick e; st.next(e); ) out.columns.push_back(e);
+            _m2_perf_account(out);
+            return out;
+        }
+
+        // ordre de tracé (draw_order, sinon identité) : lu sans copie
+        std::vector<int> identity;
+        if (S.draw_order.empty()) { identity.resize((size_t)E); std::iota(identity.begin(), identity.end(), 0); }
+        const std::vector<int>& order = S.draw_order.empty() ? identity : S.draw_order;
+        const int steps = (int)order.size();
+
+        const int K = _m2_replicas(N, P);
+        out.events.reserve(2 * (size_t)steps + 2 * (size_t)K + 3);    // borne sup. : répliques <= K
+
+        // Les trois phases sont émises en runs [INIT | FOUDRE | MAGMAT], chacun déjà (presque) trié,
+        // puis MAGMAT (ticks < 0) est remis en tête et les runs fusionnés (merge_event_runs).
+
+        // -------- PHASE 1 : INIT (ticks réels >= 0) --------
+        out.events.push_back({ 0.0, Op::PhaseMark, -1, -1, -1 }); // INIT start
+        for (int i = 0; i < steps; ++i) {
+            const double t = _m2_init_tick(i, steps, P);
+            out.events.push_back({ t, Op::InitTrace, -1, order[i], -1 });
+            out.tick_init_end = std::max(out.tick_init_end, t);
+        }
+        const size_t thunder_begin = out.events.size();
+
+        // -------- PHASE 2 : FOUDRE (ticks réels > tick_init_end) --------
+        _m2_thunder_phase(N, P, out.tick_init_end + 1.0, out, out.events);
+
+        // -------- PHASE 3 : MAGMAT (ticks réels < 0) : draw_order inverse --------
+        const size_t magmat_begin = out.events.size();
         out.tick_magmat_start = -(double)P.magmat_span;   // ex. [-span .. -ε]
         out.events.push_back({ out.tick_magmat_start, Op::PhaseMark, -1, -1, -1 }); // MAGMAT start
+        for (int k = 0; k < steps; ++k)
+            out.events.push_back({ _m2_magmat_tick(k, steps, P), Op::MagmatHeal, -1, order[(size_t)(steps - 1 - k)], -1 });
 
-        const int stepsM = (int)order.size();
-        for (int k = 0; k < stepsM; ++k) {
-            // répartir uniformément sur [-span .. 0[
-            double tn = out.tick_magmat_start + ((double)(k + 1) / (double)stepsM) * (double)P.magmat_span;
-            tn = std::min(tn, -std::numeric_limits<double>::epsilon());
-            out.events.push_back({ tn, Op::MagmatHeal, -1, order[k], -1 });
-        }
-
-        // -------- tri global (tick réel) --------
-        std::sort(out.events.begin(), out.events.end(),
-            [](const EventTick& a, const EventTick& b) {
-                if (a.tick != b.tick) return a.tick < b.tick;
-                auto rank = [](Op op) {
-                    switch (op) {
-                    case Op::PhaseMark:      return 0;
-                    case Op::InitTrace:      return 1;
-                    case Op::ThunderBreak:   return 2;
-                    case Op::ThunderReplica: return 3;
-                    case Op::MagmatHeal:     return 4;
-                    } return 5;
-                    };
-                return rank(a.op) < rank(b.op);
-            });
+        // -------- ordre global (tick réel, puis rang de l’op) --------
+        const size_t magmat_len = out.events.size() - magmat_begin;
+        std::rotate(out.events.begin(), out.events.begin() + (ptrdiff_t)magmat_begin, out.events.end());
+        merge_event_runs(out.events, { 0, magmat_len, magmat_len + thunder_begin, out.events.size() });
 
+        _m2_perf_account(out);
         return out;
     }
 
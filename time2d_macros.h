@@ -2,6 +2,7 @@
 #include <cmath>
 #include <algorithm>
 #include <utility>
+#include <vector>
 #include "time2d_i2.h"   // I2Plan / I2Params / generate_i2
 #include "time2d_m2.h"   // M2Plan (déjà utilisé)
 #include "time2d_w2.h"   // W2Plan (STRUCTURE)
@@ -86,43 +87,86 @@ namespace t2d {
     }
 
     // recherche du plus petit f tel que memorized >= goal
+    // (mêmes étapes que la recherche séquentielle d’origine, mais chaque lot de simulations
+    //  est évalué en une passe via generate_i2_factors)
     inline double _find_min_factor_for_mem(const M2Plan& m2, const I2Params& base,
         int goal, double flo, double fhi, int max_iter) {
-        // élargir le bracket si nécessaire
-        I2Plan Plo = _simulate_with_factor(m2, base, flo);
-        I2Plan Phi = _simulate_with_factor(m2, base, fhi);
+        constexpr int kWiden = 20;   // élargissements max par direction
+        constexpr int kDepth = 6;    // étapes de dichotomie par passe (2^6-1 milieux)
 
+        // élargir le bracket si nécessaire : échelles flo*0.5^k et fhi*2^k évaluées ensemble
+        double f[2 * (kWiden + 1)];
+        I2Counts c[2 * (kWiden + 1)];
+        f[0] = flo; f[kWiden + 1] = fhi;
+        for (int k = 1; k <= kWiden; ++k) { f[k] = f[k - 1] * 0.5; f[kWiden + 1 + k] = f[kWiden + k] * 2.0; }
+        generate_i2_factors(m2, base, f, c);
+
+        int ilo = 0, ihi = kWiden + 1;   // indices de Plo / Phi dans les échelles
         int safety = 0;
-        while (Plo.grains_memorized >= goal && flo > 1e-6 && safety++ < 20) {
-            fhi = flo; Phi = Plo;
+        while (c[ilo].grains_memorized >= goal && flo > 1e-6 && safety++ < kWiden) {
+            fhi = flo; ihi = ilo;
             flo *= 0.5; if (flo < 1e-6) break;
-            Plo = _simulate_with_factor(m2, base, flo);
+            ++ilo;
         }
         safety = 0;
-        while (Phi.grains_memorized < goal && fhi < 1e12 && safety++ < 20) {
-            flo = fhi; Plo = Phi;
+        while (c[ihi].grains_memorized < goal && fhi < 1e12 && safety++ < kWiden) {
+            flo = fhi;
             fhi *= 2.0;
-            Phi = _simulate_with_factor(m2, base, fhi);
+            ++ihi;
         }
-        // dichotomie
-        for (int it = 0; it < max_iter; ++it) {
-            double mid = 0.5 * (flo + fhi);
-            I2Plan Pm = _simulate_with_factor(m2, base, mid);
-            if (Pm.grains_memorized >= goal) { fhi = mid; Phi = Pm; }
-            else { flo = mid; Plo = Pm; }
+
+        // dichotomie : les milieux des kDepth prochaines étapes (arbre binaire complet) sont
+        // évalués en une passe, puis le chemin effectif est rejoué.
+        for (int it = 0; it < max_iter; ) {
+            const int depth = std::min(kDepth, max_iter - it);
+            const int nodes = (1 << depth) - 1;
+            double lo[(1 << kDepth) - 1], hi[(1 << kDepth) - 1], mid[(1 << kDepth) - 1];
+            I2Counts cm[(1 << kDepth) - 1];
+            lo[0] = flo; hi[0] = fhi;
+            for (int n = 0; n < nodes; ++n) {
+                mid[n] = 0.5 * (lo[n] + hi[n]);
+                if (2 * n + 2 < nodes) {
+                    lo[2 * n + 1] = lo[n]; hi[2 * n + 1] = mid[n];
+                    lo[2 * n + 2] = mid[n]; hi[2 * n + 2] = hi[n];
+                }
+            }
+            generate_i2_factors(m2, base, std::span<const double>(mid, (size_t)nodes), cm);
+            T2D_PERF_ADD(bisection_iterations, depth);
+
+            for (int n = 0, d = 0; d < depth; ++d) {
+                if (cm[n].grains_memorized >= goal) { fhi = mid[n]; n = 2 * n + 1; }
+                else { flo = mid[n]; n = 2 * n + 2; }
+            }
+            it += depth;
         }
         return fhi; // plus petit f atteignant la cible (approché)
     }
 
+    // cible “lost == L” traduite en mémorisés : mem >= N-L
+    inline int _mem_goal_for_lost(const M2Plan& m2, const I2Params& base, int lost_target) {
+        const int N = std::max(1, base.total_vertices_n > 0 ? base.total_vertices_n
+            : (m2.replicas_effective > 0 ? m2.replicas_effective : 1));
+        return std::max(0, N - lost_target);
+    }
+
     // idem pour une cible “lost == L” -> mem >= N-L
     inline double _find_min_factor_for_lost(const M2Plan& m2, const I2Params& base,
         int lost_target, double flo, double fhi, int max_iter) {
         if (lost_target < 0) return 1.0;
-        // cible en mémorisés :
-        const int N = std::max(1, base.total_vertices_n > 0 ? base.total_vertices_n
-            : (m2.replicas_effective > 0 ? m2.replicas_effective : 1));
-        int mem_goal = std::max(0, N - lost_target);
-        return _find_min_factor_for_mem(m2, base, mem_goal, flo, fhi, max_iter);
+        return _find_min_factor_for_mem(m2, base, _mem_goal_for_lost(m2, base, lost_target), flo, fhi, max_iter);
+    }
+
+    // plus petit f EXACT tel que memorized >= goal : statistique d’ordre (goal-ième plus petit)
+    // des seuils critiques (cf. i2_critical_factors). `thr` est réordonné, son contenu est inchangé.
+    // Cible hors [1..N] ou inatteignable : repli sur la recherche par dichotomie.
+    inline double _find_min_factor_exact(std::vector<double>& thr, const M2Plan& m2, const I2Params& base,
+        int goal, double flo, double fhi, int max_iter) {
+        if (goal >= 1 && goal <= (int)thr.size()) {
+            const auto nth = thr.begin() + (goal - 1);
+            std::nth_element(thr.begin(), nth, thr.end());
+            if (std::isfinite(*nth)) { T2D_PERF_ADD(exact_quantiles, 1); return *nth; }
+        }
+        return _find_min_factor_for_mem(m2, base, goal, flo, fhi, max_iter);
     }
 
     // -------------------------
@@ -130,6 +174,8 @@ namespace t2d {
     // -------------------------
     inline Macros compute_macros(const I2Plan& i2, const I2Params& ip,
         const M2Plan& m2, const LatencyTargets& tgt = {}, const MacroParams& mp = {}) {
+        T2D_PERF_TIMER(macros_ns);
+        T2D_PERF_ONLY(const uint64_t perf_sims0 = perf::sink() ? perf::sink()->i2_simulations : 0;)
         Macros out;
 
         const int total = std::max(1, i2.grains_memorized + i2.grains_lost);
@@ -139,26 +185,38 @@ namespace t2d {
         out.MEMORY_SPREAD_TIME_CONSTRAINT_pct = 100.0 * mem / (double)total;
 
         // (2) FACTEURS multiplicateurs sur life_mean
+        //     seuils critiques tirés une seule fois (mêmes jitters que generate_i2) ;
+        //     tampon par thread réutilisé d’un appel à l’autre => pas d’allocation en régime établi
+        //     (capacité rendue en fin d’appel au-delà de kMacrosScratchKeep seuils)
+        constexpr size_t kMacrosScratchKeep = size_t(1) << 16;   // 512 Ko par thread
+        thread_local std::vector<double> thr;
+        T2D_PERF_ONLY(const uint64_t perf_thr0 = perf::bytes_of(thr);)
+        i2_critical_factors(m2, ip, thr);
+        T2D_PERF_ADD(macros_bytes, perf::bytes_of(thr) - perf_thr0);
+
         //     - low : facteur min pour atteindre “≥ target_mem_min”
         out.MEMORY_LATENCY_TIME_FACTOR_low =
-            _find_min_factor_for_mem(m2, ip, tgt.target_mem_min, tgt.f_lo, tgt.f_hi, tgt.max_iter);
+            _find_min_factor_exact(thr, m2, ip, tgt.target_mem_min, tgt.f_lo, tgt.f_hi, tgt.max_iter);
 
         //     - high : facteur min pour atteindre “lost == target_lost_exact”
         if (tgt.target_lost_exact >= 0) {
             out.MEMORY_LATENCY_TIME_FACTOR_high =
-                _find_min_factor_for_lost(m2, ip, tgt.target_lost_exact, tgt.f_lo, tgt.f_hi, tgt.max_iter);
+                _find_min_factor_exact(thr, m2, ip, _mem_goal_for_lost(m2, ip, tgt.target_lost_exact),
+                    tgt.f_lo, tgt.f_hi, tgt.max_iter);
         }
         else {
             // pas de cible lost -> borne haute “x4 des memorized”
             const int goal4x = std::max(1, i2.grains_memorized * 4);
             out.MEMORY_LATENCY_TIME_FACTOR_high =
-                _find_min_factor_for_mem(m2, ip, goal4x, tgt.f_lo, tgt.f_hi, tgt.max_iter);
+                _find_min_factor_exact(thr, m2, ip, goal4x, tgt.f_lo, tgt.f_hi, tgt.max_iter);
         }
 
         // (3) capacité du conteneur : mémorisés projetés avec le facteur “low”
+        //     (memorized(f) == nb de seuils <= f : pas de re-simulation)
         {
-            I2Plan proj = _simulate_with_factor(m2, ip, out.MEMORY_LATENCY_TIME_FACTOR_low);
-            out.CONTAINER_RANGE_TIME = proj.grains_memorized;
+            const double f = out.MEMORY_LATENCY_TIME_FACTOR_low;
+            out.CONTAINER_RANGE_TIME = (int)std::count_if(thr.begin(), thr.end(),
+                [f](double t) { return t <= f; });
         }
 
         // (4) durée de vie collective pondérée (centre/bords)
@@ -172,21 +230,19 @@ namespace t2d {
             out.CONTAINER_FLOW_TIME = center_life * (1.0 - edge_share) + edge_life * edge_share;
         }
 
+        if (thr.capacity() > kMacrosScratchKeep) { thr.clear(); thr.shrink_to_fit(); }
+
+        T2D_PERF_ADD(macros_i2_simulations, perf::sink()->i2_simulations - perf_sims0);
+
         // Champs W2 laissés par défaut ici (0/1) — ils seront remplis par la surcharge ci-dessous.
         return out;
     }
 
     // -------------------------
-    // Surcharge : compute_macros + W2 (VENT/BOIS via macros uniquement)
+    // Agrégats W2 (VENT/BOIS via macros uniquement) : ne dépendent que de W2Plan / W2MacroControls,
+    // appliqués sur des macros déjà calculées (pas de nouvelle recherche I2)
     // -------------------------
-    inline Macros compute_macros(const I2Plan& i2, const I2Params& ip,
-        const M2Plan& m2, const W2Plan& w2,
-        const W2MacroControls& w2c,
-        const LatencyTargets& tgt = {}, const MacroParams& mp = {}) {
-        // 1) calcul “classique”
-        Macros out = compute_macros(i2, ip, m2, tgt, mp);
-
-        // 2) application des macros W2
+    inline void apply_w2_macros(Macros& out, const W2Plan& w2, const W2MacroControls& w2c) {
         const int subdivisions = std::max(1, w2.subdivision_level);
         const int capacity = std::max(0, subdivisions - 1);
 
@@ -211,7 +267,20 @@ namespace t2d {
         out.W2_DISAPPEARED = std::max(0, rebounds_target - active);
         out.W2_ENVIRONNMENT_RECOVER_TIME_TAG = w2c.ENVIRONNMENT_RECOVER_TIME;
         out.W2_ENVIRONNMENT_CORPSE_TIME = w2c.ENVIRONNMENT_CORPSE_TIME;
+    }
 
+    // -------------------------
+    // Surcharge : compute_macros + W2
+    // -------------------------
+    inline Macros compute_macros(const I2Plan& i2, const I2Params& ip,
+        const M2Plan& m2, const W2Plan& w2,
+        const W2MacroControls& w2c,
+        const LatencyTargets& tgt = {}, const MacroParams& mp = {}) {
+        // 1) calcul “classique”
+        Macros out = compute_macros(i2, ip, m2, tgt, mp);
+
+        // 2) application des macros W2
+        apply_w2_macros(out, w2, w2c);
         return out;
     }
 
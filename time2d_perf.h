@@ -0,0 +1,73 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include "time2d_interface.h"   // iface::PerfCounters (si T2D_ENABLE_PERF_COUNTERS)
+
+namespace t2d {
+    namespace perf {
+
+        // -----------------------------
+        // Compteurs de coût par étage (désactivés par défaut)
+        // -----------------------------
+        // Compiler avec -DT2D_ENABLE_PERF_COUNTERS (TOUTES les unités de traduction) pour les activer.
+        // Sinon T2D_PERF_TIMER / T2D_PERF_ADD / T2D_PERF_ONLY ne produisent aucun code (arguments non évalués)
+        // et iface::PerfCounters n’existe pas.
+        //
+        // Les étages (generate, generate_m2, generate_i2, compute_macros, ...) écrivent dans le puits
+        // du thread courant, posé par un Capture :
+        //   iface::Outputs out;
+        //   { perf::Capture cap(out.perf); ...pipeline...; }
+        // Sans Capture actif, les compteurs sont ignorés (un test de pointeur).
+
+#if defined(T2D_ENABLE_PERF_COUNTERS)
+        inline constexpr bool enabled = true;
+
+        inline thread_local iface::PerfCounters* tls_sink = nullptr;
+        inline iface::PerfCounters* sink() { return tls_sink; }
+
+        // pose `c` comme puits du thread pendant la portée (imbriquable)
+        class Capture {
+        public:
+            explicit Capture(iface::PerfCounters& c) : prev_(tls_sink) { tls_sink = &c; }
+            ~Capture() { tls_sink = prev_; }
+            Capture(const Capture&) = delete;
+            Capture& operator=(const Capture&) = delete;
+        private:
+            iface::PerfCounters* prev_;
+        };
+
+        // ajoute le temps mur de la portée (ns) au champ désigné
+        class Timer {
+        public:
+            explicit Timer(uint64_t iface::PerfCounters::* field)
+                : s_(tls_sink), field_(field), t0_(s_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+            ~Timer() {
+                if (s_) s_->*field_ += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0_).count();
+            }
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+        private:
+            iface::PerfCounters* s_;
+            uint64_t iface::PerfCounters::* field_;
+            std::chrono::steady_clock::time_point t0_;
+        };
+
+        // octets d’un vecteur (capacité)
+        template <class V>
+        inline uint64_t bytes_of(const V& v) { return (uint64_t)v.capacity() * sizeof(typename V::value_type); }
+
+#define T2D_PERF_TIMER(field) ::t2d::perf::Timer t2d_perf_timer_##field(&::t2d::iface::PerfCounters::field)
+#define T2D_PERF_ADD(field, n) do { if (auto* t2d_perf_s = ::t2d::perf::sink()) t2d_perf_s->field += (uint64_t)(n); } while (0)
+#define T2D_PERF_ONLY(...) __VA_ARGS__
+#else
+        inline constexpr bool enabled = false;
+
+#define T2D_PERF_TIMER(field) ((void)0)
+#define T2D_PERF_ADD(field, n) ((void)0)
+#define T2D_PERF_ONLY(...)
+#endif
+
+    } // namespace perf
+} // namespace t2d
@@ -0,0 +1,160 @@
+﻿#pragma once
+#include <cstdint>
+#include <algorithm>
+
+#include "randomGenPolyShape.hpp"
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+#include "time2d_w2.h"
+#include "time2d_macros.h"
+
+namespace t2d {
+
+    // -----------------------------
+    // Pipeline incrémental : forme -> M2 -> I2 -> macros -> W2 -> macros W2
+    // -----------------------------
+    // Possède les paramètres et les résultats de chaque étage. Un setter marque son étage et tous
+    // ses dépendants comme périmés ; update() ne recalcule que les étages périmés, dans l’ordre.
+    //   Shape    <- shape_params
+    //   M2       <- Shape, m2_params (+ replicas_divisor)
+    //   I2       <- M2, i2_params (N et r hérités de la forme)
+    //   Macros   <- I2, M2, i2_params, targets (+ retention_factor), macro_params   (recherches I2)
+    //   W2       <- I2, w2_params
+    //   W2Macros <- Macros, W2, w2_controls                                       (agrégats seuls)
+    // Modifier W2 ou ses contrôles ne relance donc aucune recherche I2.
+    class Pipeline {
+    public:
+        enum Stage : unsigned {
+            StageShape = 1u << 0,
+            StageM2 = 1u << 1,
+            StageI2 = 1u << 2,
+            StageMacros = 1u << 3,
+            StageW2 = 1u << 4,
+            StageW2Macros = 1u << 5,
+            StageAll = (1u << 6) - 1
+        };
+
+        Pipeline() = default;
+
+        // ---------- entrées ----------
+        const t2dgen::RandomGenPolyShape::Params& shape_params() const { return shape_p_; }
+        const M2Params&        m2_params()     const { return m2_p_; }
+        const I2Params&        i2_params()     const { return i2_p_; }
+        const LatencyTargets&  targets()       const { return tgt_; }
+        const MacroParams&     macro_params()  const { return mp_; }
+        const W2Params&        w2_params()     const { return w2_p_; }
+        const W2MacroControls& w2_controls()   const { return w2c_; }
+        int replicas_divisor() const { return replicas_divisor_; }
+        int retention_factor() const { return retention_factor_; }
+
+        void set_shape_params(const t2dgen::RandomGenPolyShape::Params& p) { shape_p_ = p; invalidate(StageShape); }
+        void set_m2_params(const M2Params& p) { m2_p_ = p; invalidate(StageM2); }
+        void set_i2_params(const I2Params& p) { i2_p_ = p; invalidate(StageI2); }
+        void set_targets(const LatencyTargets& t) { tgt_ = t; invalidate(StageMacros); }
+        void set_macro_params(const MacroParams& p) { mp_ = p; invalidate(StageMacros); }
+        void set_w2_params(const W2Params& p) { w2_p_ = p; invalidate(StageW2); }
+        void set_w2_controls(const W2MacroControls& c) { w2c_ = c; invalidate(StageW2Macros); }
+
+        // >0 : replicas_k = N / divisor borné [1, N-1] (comme metatime) ; <=0 : m2_params().replicas_k
+        void set_replicas_divisor(int d) { replicas_divisor_ = d; invalidate(StageM2); }
+        // >0 : cibles dérivées de l’I2 (lost / RET, comme metatime) ; <=0 : targets() tels quels
+        void set_retention_factor(int r) { retention_factor_ = r; invalidate(StageMacros); }
+
+        // ---------- recalcul ----------
+        void invalidate(unsigned stage) { dirty_ |= stage | downstream(stage); }
+        bool stale(unsigned stage) const { return (dirty_ & stage) != 0; }
+
+        // recalcule les étages périmés ; renvoie le masque des étages effectivement recalculés
+        unsigned update() {
+            unsigned done = 0;
+            if (dirty_ & StageShape) {
+                t2dgen::RandomGenPolyShape gen(shape_p_);
+                gen.generate_into(shape_);
+                iterations_ = gen.iterations();
+                done |= StageShape;
+            }
+            if (dirty_ & StageM2) {
+                M2Params mp = m2_p_;
+                const int N = (int)shape_.V.size();
+                if (replicas_divisor_ > 0)
+                    mp.replicas_k = std::min(std::max(1, N / replicas_divisor_), std::max(1, N - 1));
+                m2_ = generate_m2(shape_, mp);
+                done |= StageM2;
+            }
+            if (dirty_ & StageI2) {
+                ip_eff_ = i2_p_;
+                ip_eff_.total_vertices_n = (int)shape_.V.size();
+                ip_eff_.iterations_inherited = iterations_;
+                i2_ = generate_i2(m2_, ip_eff_);
+                done |= StageI2;
+            }
+            if (dirty_ & StageMacros) {
+                tgt_eff_ = tgt_;
+                if (retention_factor_ > 0) {
+                    tgt_eff_.target_lost_exact = std::max(0, i2_.grains_lost / retention_factor_);
+                    tgt_eff_.target_mem_min = std::max(0, i2_.grains_total - tgt_eff_.target_lost_exact);
+                }
+                core_ = compute_macros(i2_, ip_eff_, m2_, tgt_eff_, mp_);
+                done |= StageMacros;
+            }
+            if (dirty_ & StageW2) {
+                w2_ = generate_w2_structure(i2_, w2_p_);
+                done |= StageW2;
+            }
+            if (dirty_ & StageW2Macros) {
+                macros_ = core_;
+                apply_w2_macros(macros_, w2_, w2c_);
+                done |= StageW2Macros;
+            }
+            dirty_ = 0;
+            return done;
+        }
+
+        // ---------- résultats (update() implicite) ----------
+        const Shape&  shape()  { update(); return shape_; }
+        const M2Plan& m2()     { update(); return m2_; }
+        const I2Plan& i2()     { update(); return i2_; }
+        const W2Plan& w2()     { update(); return w2_; }
+        const Macros& macros() { update(); return macros_; }          // avec agrégats W2
+
+        int iterations()                   { update(); return iterations_; }
+        const I2Params& i2_params_effective()    { update(); return ip_eff_; }   // N / r renseignés
+        const LatencyTargets& targets_effective() { update(); return tgt_eff_; }
+
+    private:
+        static unsigned downstream(unsigned stage) {
+            unsigned d = 0;
+            if (stage & StageShape)  d |= StageM2 | StageI2 | StageMacros | StageW2 | StageW2Macros;
+            if (stage & StageM2)     d |= StageI2 | StageMacros | StageW2 | StageW2Macros;
+            if (stage & StageI2)     d |= StageMacros | StageW2 | StageW2Macros;
+            if (stage & StageMacros) d |= StageW2Macros;
+            if (stage & StageW2)     d |= StageW2Macros;
+            return d;
+        }
+
+        // entrées
+        t2dgen::RandomGenPolyShape::Params shape_p_{};
+        M2Params        m2_p_{};
+        I2Params        i2_p_{};
+        LatencyTargets  tgt_{};
+        MacroParams     mp_{};
+        W2Params        w2_p_{};
+        W2MacroControls w2c_{};
+        int replicas_divisor_{ 0 };
+        int retention_factor_{ 0 };
+
+        // résultats
+        Shape          shape_;
+        int            iterations_{ 0 };
+        M2Plan         m2_;
+        I2Params       ip_eff_{};
+        I2Plan         i2_;
+        LatencyTargets tgt_eff_{};
+        Macros         core_;        // macros sans W2
+        W2Plan         w2_;
+        Macros         macros_;      // core_ + agrégats W2
+
+        unsigned dirty_{ StageAll };
+    };
+
+} // namespace t2d
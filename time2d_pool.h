@@ -0,0 +1,125 @@
+﻿#pragma once
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+namespace t2d {
+
+    // -----------------------------
+    // Pool de threads minimal (parallel_for)
+    // -----------------------------
+    // - Les tâches [0, n) sont réclamées dynamiquement (compteur atomique) : équilibrage de charge.
+    // - Le thread appelant participe ; un seul parallel_for actif à la fois par pool.
+    // - Appel imbriqué (depuis une tâche) : exécuté en séquentiel sur le thread courant.
+    // - Le découpage des données est à la charge de l’appelant : pour un résultat indépendant du
+    //   nombre de threads, découper en blocs de taille FIXE et fusionner les partiels dans l’ordre.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned threads = 0) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            workers_.reserve(threads - 1);
+            for (unsigned t = 1; t < threads; ++t) workers_.emplace_back([this] { worker_loop(); });
+        }
+
+        ~ThreadPool() {
+            { std::lock_guard<std::mutex> lk(m_); stop_ = true; }
+            cv_.notify_all();
+            for (auto& w : workers_) w.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned size() const { return (unsigned)workers_.size() + 1; }
+
+        // pool partagé du processus (hardware_concurrency threads)
+        static ThreadPool& shared() { static ThreadPool pool; return pool; }
+
+        // exécute fn(i) pour tout i de [0, n) ; bloque jusqu’à la fin (exceptions relancées ici)
+        template <class F>
+        void parallel_for(size_t n, F&& fn) {
+            if (n == 0) return;
+            if (workers_.empty() || n == 1 || in_task()) {
+                for (size_t i = 0; i < n; ++i) fn(i);
+                return;
+            }
+
+            std::lock_guard<std::mutex> one_job(submit_m_);
+            Job job;
+            job.n = n;
+            job.fn = [&fn](size_t i) { fn(i); };
+            { std::lock_guard<std::mutex> lk(m_); job_ = &job; ++generation_; }
+            cv_.notify_all();
+
+            run(job);
+
+            {
+                std::unique_lock<std::mutex> lk(m_);
+                done_cv_.wait(lk, [&] { return job.active == 0; });
+                job_ = nullptr;
+            }
+            if (job.error) std::rethrow_exception(job.error);
+        }
+
+    private:
+        struct Job {
+            size_t n{};
+            std::function<void(size_t)> fn;
+            std::atomic<size_t> next{ 0 };
+            int active{ 0 };                 // workers engagés (protégé par m_)
+            std::exception_ptr error;        // première exception (protégée par err_m)
+            std::mutex err_m;
+        };
+
+        static bool& in_task() { thread_local bool flag = false; return flag; }
+
+        static void run(Job& job) {
+            bool& flag = in_task();
+            const bool prev = flag;
+            flag = true;
+            for (size_t i; (i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.n; ) {
+                try { job.fn(i); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lk(job.err_m);
+                    if (!job.error) job.error = std::current_exception();
+                }
+            }
+            flag = prev;
+        }
+
+        void worker_loop() {
+            unsigned long long seen = 0;
+            for (;;) {
+                Job* job = nullptr;
+                {
+                    std::unique_lock<std::mutex> lk(m_);
+                    cv_.wait(lk, [&] { return stop_ || (job_ && generation_ != seen); });
+                    if (stop_) return;
+                    seen = generation_;
+                    job = job_;
+                    ++job->active;
+                }
+                run(*job);
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    --job->active;
+                }
+                done_cv_.notify_all();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::mutex m_, submit_m_;
+        std::condition_variable cv_, done_cv_;
+        Job* job_{ nullptr };
+        unsigned long long generation_{ 0 };
+        bool stop_{ false };
+    };
+
+} // namespace t2d
@@ -0,0 +1,363 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <bit>
+#include <span>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <type_traits>
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+
+namespace t2d {
+
+    // -----------------------------
+    // Snapshot binaire (Shape / M2Plan / I2Plan) lu par mmap, sans analyse ni copie
+    // -----------------------------
+    // Fichier little-endian, versionné :
+    //   SnapHeader | SnapSection[section_count] | sections (alignées sur 64 octets)
+    // Chaque section est un tableau plat d’éléments de taille fixe, avec sa somme de contrôle.
+    // Les vues renvoient des spans directement dans le mapping (valides tant que le Snapshot vit).
+
+    inline constexpr char     kSnapMagic[8] = { 'T','2','D','S','N','A','P','\0' };
+    inline constexpr uint32_t kSnapVersion = 1;
+    inline constexpr uint32_t kSnapEndianTag = 0x01020304u;
+
+    enum class SnapKind : uint32_t {
+        ShapeVertices = 1,   // Vec2
+        ShapeSegments = 2,   // Segment
+        ShapeDrawOrder = 3,  // int32
+        M2Meta = 4,          // SnapM2Meta (1 élément)
+        M2Events = 5,        // EventTick
+        I2Meta = 6,          // SnapI2Meta (1 élément)
+        I2Samples = 7        // SnapGrainSample
+    };
+
+    struct SnapHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t endian;          // kSnapEndianTag tel qu’écrit en little-endian
+        uint32_t section_count;
+        uint32_t flags;           // réservé (0)
+        uint64_t file_size;
+        uint64_t table_checksum;  // somme de la table des sections
+    };
+
+    struct SnapSection {
+        uint32_t kind;
+        uint32_t elem_size;
+        uint64_t offset;          // depuis le début du fichier
+        uint64_t count;
+        uint64_t checksum;        // somme des count * elem_size octets
+    };
+
+    // métriques scalaires (disposition figée sur disque)
+    struct SnapM2Meta {
+        double  tick_init_end, tick_thunder_end, tick_magmat_start;
+        double  thunder_min_gap, thunder_tau;
+        int32_t replicas_effective, reserved;
+    };
+
+    struct SnapI2Meta {
+        int32_t replicas_k, total_vertices_n, iterations_inherited, grains_total;
+        int32_t grains_memorized, grains_lost;
+        double  inverse_ratio, passage_dimension, throughput, service_time;
+        double  rate_memorized, mean_finish_time;
+    };
+
+    struct SnapGrainSample {
+        int32_t id, memorized;
+        double  life, wait_time, pass_time, finish_time;
+    };
+
+    // les types mappés tels quels doivent avoir une disposition fixe
+    static_assert(sizeof(SnapHeader) == 40 && sizeof(SnapSection) == 32);
+    static_assert(sizeof(Vec2) == 16 && std::is_trivially_copyable_v<Vec2>);
+    static_assert(sizeof(Segment) == 8 && std::is_trivially_copyable_v<Segment>);
+    static_assert(sizeof(EventTick) == 24 && sizeof(Op) == 4 && std::is_trivially_copyable_v<EventTick>);
+    static_assert(sizeof(SnapM2Meta) == 48 && sizeof(SnapI2Meta) == 72 && sizeof(SnapGrainSample) == 40);
+
+    // somme de contrôle 64 bits (mots de 8 octets, mélange multiplicatif ; queue octet par octet)
+    inline uint64_t snapshot_checksum(const void* data, size_t n) {
+        const unsigned char* p = (const unsigned char*)data;
+        uint64_t h = 0x243f6a8885a308d3ULL ^ (uint64_t)n;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w; std::memcpy(&w, p + i, 8);
+            h = std::rotl(h ^ (w * 0x9e3779b97f4a7c15ULL), 27) * 0xbf58476d1ce4e5b9ULL;
+        }
+        for (; i < n; ++i) h = (h ^ p[i]) * 0x100000001b3ULL;
+        h ^= h >> 31; h *= 0x94d049bb133111ebULL; h ^= h >> 29;
+        return h;
+    }
+
+    // ---------- écriture ----------
+    // Chaque pointeur nul omet les sections correspondantes. Renvoie false (et `error`) en cas d’échec.
+    inline bool write_snapshot(const std::string& path, const Shape* shape, const M2Plan* m2, const I2Plan* i2,
+        std::string* error = nullptr) {
+        auto fail = [&](const char* msg) { if (error) *error = msg; return false; };
+        if constexpr (std::endian::native != std::endian::little) return fail("snapshot: hôte big-endian non supporté");
+
+        struct Blob { SnapKind kind; uint32_t elem; const void* data; uint64_t count; };
+        std::vector<Blob> blobs;
+
+        SnapM2Meta m2meta{};
+        std::vector<EventTick> m2events;   // uniquement si le plan est en colonnes
+        SnapI2Meta i2meta{};
+        std::vector<SnapGrainSample> samples;
+
+        if (shape) {
+            blobs.push_back({ SnapKind::ShapeVertices, sizeof(Vec2), shape->V.data(), shape->V.size() });
+            blobs.push_back({ SnapKind::ShapeSegments, sizeof(Segment), shape->E.data(), shape->E.size() });
+            blobs.push_back({ SnapKind::ShapeDrawOrder, sizeof(int32_t), shape->draw_order.data(), shape->draw_order.size() });
+        }
+        if (m2) {
+            m2meta = { m2->tick_init_end, m2->tick_thunder_end, m2->tick_magmat_start,
+                       m2->thunder_min_gap, m2->thunder_tau, m2->replicas_effective, 0 };
+            blobs.push_back({ SnapKind::M2Meta, sizeof(SnapM2Meta), &m2meta, 1 });
+            const EventTick* ev = m2->events.data();
+            if (!m2->columns.empty()) { m2events = m2->columns.to_events(); ev = m2events.data(); }
+            blobs.push_back({ SnapKind::M2Events, sizeof(EventTick), ev, m2->event_count() });
+        }
+        if (i2) {
+            i2meta = { i2->replicas_k, i2->total_vertices_n, i2->iterations_inherited, i2->grains_total,
+                       i2->grains_memorized, i2->grains_lost,
+                       i2->inverse_ratio, i2->passage_dimension, i2->throughput, i2->service_time,
+                       i2->rate_memorized, i2->mean_finish_time };
+            blobs.push_back({ SnapKind::I2Meta, sizeof(SnapI2Meta), &i2meta, 1 });
+            samples.reserve(i2->samples.size());
+            for (const auto& g : i2->samples)
+                samples.push_back({ g.id, g.memorized ? 1 : 0, g.life, g.wait_time, g.pass_time, g.finish_time });
+            blobs.push_back({ SnapKind::I2Samples, sizeof(SnapGrainSample), samples.data(), samples.size() });
+        }
+
+        auto align64 = [](uint64_t x) { return (x + 63) & ~(uint64_t)63; };
+        std::vector<SnapSection> table(blobs.size());
+        uint64_t off = align64(sizeof(SnapHeader) + table.size() * sizeof(SnapSection));
+        for (size_t s = 0; s < blobs.size(); ++s) {
+            const uint64_t bytes = blobs[s].count * blobs[s].elem;
+            table[s] = { (uint32_t)blobs[s].kind, blobs[s].elem, off, blobs[s].count,
+                         snapshot_checksum(blobs[s].data, (size_t)bytes) };
+            off = align64(off + bytes);
+        }
+
+        SnapHeader h{};
+        std::memcpy(h.magic, kSnapMagic, 8);
+        h.version = kSnapVersion;
+        h.endian = kSnapEndianTag;
+        h.section_count = (uint32_t)table.size();
+        h.file_size = off;
+        h.table_checksum = snapshot_checksum(table.data(), table.size() * sizeof(SnapSection));
+
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f) return fail("snapshot: ouverture en écriture impossible");
+        static const char zeros[64] = {};
+        uint64_t pos = 0;
+        auto put = [&](const void* d, uint64_t n) { f.write((const char*)d, (std::streamsize)n); pos += n; };
+        auto pad = [&](uint64_t to) { while (pos < to) put(zeros, std::min<uint64_t>(64, to - pos)); };
+
+        put(&h, sizeof h);
+        put(table.data(), table.size() * sizeof(SnapSection));
+        for (size_t s = 0; s < blobs.size(); ++s) {
+            pad(table[s].offset);
+            put(blobs[s].data, table[s].count * table[s].elem_size);
+        }
+        pad(h.file_size);
+        if (!f) return fail("snapshot: erreur d’écriture");
+        return true;
+    }
+
+    // ---------- mapping lecture seule (POSIX / Win32) ----------
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& o) noexcept { swap(o); }
+        MappedFile& operator=(MappedFile&& o) noexcept { if (this != &o) { close(); swap(o); } return *this; }
+        ~MappedFile() { close(); }
+
+        bool open(const std::string& path) {
+            close();
+#if defined(_WIN32)
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) { file_ = nullptr; return false; }
+            LARGE_INTEGER sz;
+            if (!GetFileSizeEx(file_, &sz) || sz.QuadPart == 0) { close(); return false; }
+            size_ = (size_t)sz.QuadPart;
+            map_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!map_) { close(); return false; }
+            data_ = (const unsigned char*)MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0);
+            if (!data_) { close(); return false; }
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+            size_ = (size_t)st.st_size;
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) { size_ = 0; return false; }
+            data_ = (const unsigned char*)p;
+#endif
+            return true;
+        }
+
+        void close() {
+#if defined(_WIN32)
+            if (data_) UnmapViewOfFile(data_);
+            if (map_) CloseHandle(map_);
+            if (file_) CloseHandle(file_);
+            map_ = nullptr; file_ = nullptr;
+#else
+            if (data_) munmap((void*)data_, size_);
+#endif
+            data_ = nullptr; size_ = 0;
+        }
+
+        const unsigned char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        void swap(MappedFile& o) noexcept {
+            std::swap(data_, o.data_); std::swap(size_, o.size_);
+#if defined(_WIN32)
+            std::swap(file_, o.file_); std::swap(map_, o.map_);
+#endif
+        }
+
+        const unsigned char* data_{ nullptr };
+        size_t size_{ 0 };
+#if defined(_WIN32)
+        HANDLE file_{ nullptr }, map_{ nullptr };
+#endif
+    };
+
+    // ---------- vues ----------
+    struct ShapeView {
+        std::span<const Vec2>    V;
+        std::span<const Segment> E;
+        std::span<const int>     draw_order;
+        Shape to_shape() const {
+            return { { V.begin(), V.end() }, { E.begin(), E.end() }, { draw_order.begin(), draw_order.end() } };
+        }
+    };
+
+    struct M2PlanView {
+        const SnapM2Meta*          meta{ nullptr };
+        std::span<const EventTick> events;
+    };
+
+    struct I2PlanView {
+        const SnapI2Meta*                meta{ nullptr };
+        std::span<const SnapGrainSample> samples;
+    };
+
+    class Snapshot {
+    public:
+        // mappe et valide (en-tête, table, bornes ; sommes de contrôle si `verify`).
+        // L’instantané précédent est fermé ; en cas d’échec l’objet reste vide (has_*() == false).
+        bool open(const std::string& path, bool verify = true, std::string* error = nullptr) {
+            reset();
+            auto fail = [&](const char* msg) { reset(); if (error) *error = msg; return false; };
+            if constexpr (std::endian::native != std::endian::little) return fail("snapshot: hôte big-endian non supporté");
+            if (!file_.open(path)) return fail("snapshot: ouverture / mapping impossible");
+
+            const unsigned char* base = file_.data();
+            const size_t size = file_.size();
+            if (size < sizeof(SnapHeader)) return fail("snapshot: fichier tronqué");
+            SnapHeader h;
+            std::memcpy(&h, base, sizeof h);
+            if (std::memcmp(h.magic, kSnapMagic, 8) != 0) return fail("snapshot: signature invalide");
+            if (h.version != kSnapVersion) return fail("snapshot: version non supportée");
+            if (h.endian != kSnapEndianTag) return fail("snapshot: boutisme invalide");
+            if (h.file_size != size) return fail("snapshot: taille incohérente");
+            const uint64_t table_bytes = (uint64_t)h.section_count * sizeof(SnapSection);
+            if (h.section_count > 64 || sizeof(SnapHeader) + table_bytes > size) return fail("snapshot: table invalide");
+
+            const SnapSection* table = reinterpret_cast<const SnapSection*>(base + sizeof(SnapHeader));
+            if (verify && snapshot_checksum(table, (size_t)table_bytes) != h.table_checksum)
+                return fail("snapshot: somme de contrôle de la table");
+            for (uint32_t s = 0; s < h.section_count; ++s) {
+                const SnapSection& t = table[s];
+                if (t.offset > size || t.offset % 8 != 0 || t.elem_size == 0 || t.count > (size - t.offset) / t.elem_size)
+                    return fail("snapshot: section hors fichier");
+                if (t.elem_size != expected_size(t.kind)) return fail("snapshot: taille d’élément inattendue");
+                if (verify && snapshot_checksum(base + t.offset, (size_t)(t.count * t.elem_size)) != t.checksum)
+                    return fail("snapshot: somme de contrôle de section");
+            }
+            h_ = h;
+            table_ = table;
+            return true;
+        }
+
+        bool has_shape() const { return find(SnapKind::ShapeVertices) != nullptr; }
+        bool has_m2()    const { return find(SnapKind::M2Meta) != nullptr; }
+        bool has_i2()    const { return find(SnapKind::I2Meta) != nullptr; }
+
+        ShapeView shape() const {
+            return { span<Vec2>(SnapKind::ShapeVertices), span<Segment>(SnapKind::ShapeSegments),
+                     span<int>(SnapKind::ShapeDrawOrder) };
+        }
+        M2PlanView m2() const {
+            const auto m = span<SnapM2Meta>(SnapKind::M2Meta);
+            return { m.empty() ? nullptr : m.data(), span<EventTick>(SnapKind::M2Events) };
+        }
+        I2PlanView i2() const {
+            const auto m = span<SnapI2Meta>(SnapKind::I2Meta);
+            return { m.empty() ? nullptr : m.data(), span<SnapGrainSample>(SnapKind::I2Samples) };
+        }
+
+        const SnapHeader& header() const { return h_; }
+
+    private:
+        void reset() { file_.close(); h_ = {}; table_ = nullptr; }
+
+        static uint32_t expected_size(uint32_t kind) {
+            switch ((SnapKind)kind) {
+            case SnapKind::ShapeVertices:  return sizeof(Vec2);
+            case SnapKind::ShapeSegments:  return sizeof(Segment);
+            case SnapKind::ShapeDrawOrder: return sizeof(int32_t);
+            case SnapKind::M2Meta:         return sizeof(SnapM2Meta);
+            case SnapKind::M2Events:       return sizeof(EventTick);
+            case SnapKind::I2Meta:         return sizeof(SnapI2Meta);
+            case SnapKind::I2Samples:      return sizeof(SnapGrainSample);
+            }
+            return 0;
+        }
+
+        const SnapSection* find(SnapKind k) const {
+            for (uint32_t s = 0; s < h_.section_count; ++s)
+                if (table_[s].kind == (uint32_t)k) return &table_[s];
+            return nullptr;
+        }
+
+        template <class T>
+        std::span<const T> span(SnapKind k) const {
+            const SnapSection* t = find(k);
+            if (!t || t->count == 0) return {};
+            return { reinterpret_cast<const T*>(file_.data() + t->offset), (size_t)t->count };
+        }
+
+        MappedFile file_;
+        SnapHeader h_{};
+        const SnapSection* table_{ nullptr };
+    };
+
+} // namespace t2d
@@ -0,0 +1,164 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+
+#include "randomGenPolyShape.hpp"
+#include "time2d_m2.h"
+#include "time2d_i2.h"
+#include "time2d_macros.h"
+#include "time2d_pool.h"
+
+namespace t2d {
+
+    // -----------------------------
+    // Balayage de paramètres (grille) : forme -> M2 -> I2 -> macros, en parallèle
+    // -----------------------------
+    // Axes (produit cartésien, life_mean le plus interne) :
+    //   iterations (r) x replicas_k x force_rate x life_jitter x life_mean
+    // Réutilisation des étages : une forme par r, un plan M2 par (r, k), une passe I2 multi-facteurs
+    // (generate_i2_factors) pour toutes les valeurs de life_mean d’un même (r, k, force, jitter).
+    // Les graines viennent des paramètres de base : le résultat ne dépend pas du nombre de threads.
+    struct SweepGrid {
+        t2dgen::RandomGenPolyShape::Params shape{};   // fixed_iterations remplacé par l’axe `iterations`
+        M2Params       m2{};                            // replicas_k remplacé par l’axe
+        I2Params       i2{};                            // force_rate / life_jitter / life_mean remplacés
+        LatencyTargets targets{};
+        MacroParams    macro{};
+        int            retention_factor{ 4 };           // >0 : cibles dérivées comme metatime (lost / RET)
+
+        std::vector<int>    iterations{ 4 };
+        std::vector<int>    replicas_k{ 8 };
+        std::vector<double> force_rate{ 0.05 };
+        std::vector<double> life_jitter{ 0.20 };
+        std::vector<double> life_mean{ 10.0 };          // valeurs < 1e-9 bornées à 1e-9
+
+        size_t points() const {
+            return iterations.size() * replicas_k.size() * force_rate.size() * life_jitter.size() * life_mean.size();
+        }
+    };
+
+    // Résultats en colonnes : une colonne par champ, ligne = indice du point de la grille
+    struct SweepColumns {
+        // axes
+        std::vector<int>    iterations, replicas_k;
+        std::vector<double> force_rate, life_jitter, life_mean;
+
+        // forme / M2
+        std::vector<int>    vertices_n, replicas_effective;
+        std::vector<double> thunder_min_gap, thunder_tau;
+
+        // I2Plan
+        std::vector<int>    grains_total, grains_memorized, grains_lost;
+        std::vector<double> service_time, rate_memorized, mean_finish_time;
+
+        // Macros
+        std::vector<double> MEMORY_SPREAD_TIME_CONSTRAINT_pct;
+        std::vector<double> MEMORY_LATENCY_TIME_FACTOR_low, MEMORY_LATENCY_TIME_FACTOR_high;
+        std::vector<int>    CONTAINER_RANGE_TIME;
+        std::vector<double> CONTAINER_FLOW_TIME;
+
+        size_t size() const { return life_mean.size(); }
+
+        void resize(size_t n) {
+            iterations.resize(n); replicas_k.resize(n);
+            force_rate.resize(n); life_jitter.resize(n); life_mean.resize(n);
+            vertices_n.resize(n); replicas_effective.resize(n);
+            thunder_min_gap.resize(n); thunder_tau.resize(n);
+            grains_total.resize(n); grains_memorized.resize(n); grains_lost.resize(n);
+            service_time.resize(n); rate_memorized.resize(n); mean_finish_time.resize(n);
+            MEMORY_SPREAD_TIME_CONSTRAINT_pct.resize(n);
+            MEMORY_LATENCY_TIME_FACTOR_low.resize(n); MEMORY_LATENCY_TIME_FACTOR_high.resize(n);
+            CONTAINER_RANGE_TIME.resize(n); CONTAINER_FLOW_TIME.resize(n);
+        }
+    };
+
+    inline SweepColumns run_sweep(const SweepGrid& g, ThreadPool& pool = ThreadPool::shared()) {
+        SweepColumns out;
+        const size_t nR = g.iterations.size(), nK = g.replicas_k.size(), nF = g.force_rate.size();
+        const size_t nJ = g.life_jitter.size(), nL = g.life_mean.size();
+        const size_t total = g.points();
+        out.resize(total);
+        if (total == 0) return out;
+
+        // 1) une forme par r
+        std::vector<Shape> shapes(nR);
+        std::vector<int> shape_r(nR);
+        pool.parallel_for(nR, [&](size_t ir) {
+            t2dgen::RandomGenPolyShape::Params sp = g.shape;
+            sp.fixed_iterations = g.iterations[ir];
+            t2dgen::RandomGenPolyShape gen(sp);
+            shapes[ir] = gen.generate();
+            shape_r[ir] = gen.iterations();
+            });
+
+        // 2) un plan M2 par (r, k)
+        std::vector<M2Plan> plans(nR * nK);
+        pool.parallel_for(nR * nK, [&](size_t m) {
+            M2Params mp = g.m2;
+            mp.replicas_k = g.replicas_k[m % nK];
+            plans[m] = generate_m2(shapes[m / nK], mp);
+            });
+
+        // 3) I2 : une passe multi-facteurs par groupe (r, k, force, jitter) sur tous les life_mean
+        const size_t groups = total / nL;
+        pool.parallel_for(groups, [&](size_t grp) {
+            const size_t iJ = grp % nJ, iF = (grp / nJ) % nF, m = grp / (nJ * nF);
+            const size_t ir = m / nK, ik = m % nK;
+            const Shape& S = shapes[ir];
+            const M2Plan& m2 = plans[m];
+
+            I2Params ip = g.i2;
+            ip.total_vertices_n = (int)S.V.size();
+            ip.iterations_inherited = shape_r[ir];
+            ip.force_rate = g.force_rate[iF];
+            ip.life_jitter = g.life_jitter[iJ];
+            ip.life_mean = 1.0;                        // facteur j == life_mean[j]
+            ip.sample_max = 0;
+
+            const I2Flow fl = _i2_flow(m2, ip);
+            const size_t p0 = grp * nL;
+            std::vector<I2Counts> counts(nL);
+            generate_i2_factors(m2, ip, g.life_mean, counts);
+
+            for (size_t iL = 0; iL < nL; ++iL) {
+                const size_t p = p0 + iL;
+                ip.life_mean = std::max(1e-9, g.life_mean[iL]);
+
+                const I2Plan i2 = _i2_plan_from_counts(fl, counts[iL]);
+
+                LatencyTargets tgt = g.targets;
+                if (g.retention_factor > 0) {
+                    tgt.target_lost_exact = std::max(0, i2.grains_lost / g.retention_factor);
+                    tgt.target_mem_min = std::max(0, i2.grains_total - tgt.target_lost_exact);
+                }
+                const Macros mx = compute_macros(i2, ip, m2, tgt, g.macro);
+
+                out.iterations[p] = shape_r[ir];
+                out.replicas_k[p] = g.replicas_k[ik];
+                out.force_rate[p] = ip.force_rate;
+                out.life_jitter[p] = ip.life_jitter;
+                out.life_mean[p] = ip.life_mean;
+                out.vertices_n[p] = (int)S.V.size();
+                out.replicas_effective[p] = m2.replicas_effective;
+                out.thunder_min_gap[p] = m2.thunder_min_gap;
+                out.thunder_tau[p] = m2.thunder_tau;
+                out.grains_total[p] = i2.grains_total;
+                out.grains_memorized[p] = i2.grains_memorized;
+                out.grains_lost[p] = i2.grains_lost;
+                out.service_time[p] = i2.service_time;
+                out.rate_memorized[p] = i2.rate_memorized;
+                out.mean_finish_time[p] = i2.mean_finish_time;
+                out.MEMORY_SPREAD_TIME_CONSTRAINT_pct[p] = mx.MEMORY_SPREAD_TIME_CONSTRAINT_pct;
+                out.MEMORY_LATENCY_TIME_FACTOR_low[p] = mx.MEMORY_LATENCY_TIME_FACTOR_low;
+                out.MEMORY_LATENCY_TIME_FACTOR_high[p] = mx.MEMORY_LATENCY_TIME_FACTOR_high;
+                out.CONTAINER_RANGE_TIME[p] = mx.CONTAINER_RANGE_TIME;
+                out.CONTAINER_FLOW_TIME[p] = mx.CONTAINER_FLOW_TIME;
+            }
+            });
+
+        return out;
+    }
+
+} // namespace t2d
@@ -0,0 +1,86 @@
+﻿#pragma once
+#include <cstddef>
+#include <algorithm>
+#include "time2d_i2.h"   // I2Plan (parent logique de W2)
+
+namespace t2d {
+
+    // -----------------------------
+    // w2 : Vent (structure, empreintes) + Bois (maintien)
+    // -----------------------------
+    // Structure seule : slot 0 = container, slots 1..capacity = empreintes potentielles.
+    // L’état effectif (cible / actives / disparues) est décidé par les macros (apply_w2_macros).
+    // Slots stockés en place (capacité fixe kW2MaxSlots = W2Limits::max_subdiv) : aucune allocation.
+
+    inline constexpr int kW2MaxSlots = 64;
+
+    struct W2Params {
+        int    subdivision_level{ 3 };   // >=1, borné à kW2MaxSlots ; capacité = level-1
+        double offset_step{ 0.15 };      // décalage entre deux slots successifs (signe libre)
+
+        // atténuation des empreintes : life_k = CORPSE / (1 + SUPPORT * k)
+        double support_time{ 0.0 };      // PROCESS_SUPPORT_TIME (>=0)
+        double corpse_time{ 0.0 };       // ENVIRONNMENT_CORPSE_TIME (>=0)
+    };
+
+    struct W2Slot {
+        int    index{ 0 };          // k (0 = container)
+        int    subdivision{ 0 };    // subdivisions restantes : level - k
+        double offset{ 0.0 };       // k * offset_step
+        double life{ 0.0 };         // CORPSE / (1 + SUPPORT * k)
+    };
+
+    // tableau de slots à capacité fixe (interface de conteneur minimale)
+    class W2Slots {
+    public:
+        static constexpr int kCapacity = kW2MaxSlots;
+
+        size_t size() const { return (size_t)n_; }
+        bool   empty() const { return n_ == 0; }
+        static constexpr size_t capacity() { return (size_t)kCapacity; }
+
+        W2Slot&       operator[](size_t i) { return s_[i]; }
+        const W2Slot& operator[](size_t i) const { return s_[i]; }
+
+        W2Slot*       begin() { return s_; }
+        W2Slot*       end() { return s_ + n_; }
+        const W2Slot* begin() const { return s_; }
+        const W2Slot* end() const { return s_ + n_; }
+
+        void resize(int n) { n_ = std::clamp(n, 0, kCapacity); }
+
+    private:
+        W2Slot s_[kCapacity]{};
+        int    n_{ 0 };
+    };
+
+    struct W2Plan {
+        int     subdivision_level{ 1 };
+        double  offset_step{ 0.0 };
+        int     rebounds_capacity{ 0 };   // max(0, subdivision_level - 1)
+        W2Slots slots;                    // subdivision_level slots
+    };
+
+    // Structure W2 en une passe (offsets + vies) ; ne dépend pas du contenu de l’I2Plan.
+    inline W2Plan generate_w2_structure(const I2Plan& /*i2*/, const W2Params& P) {
+        W2Plan out;
+        const int level = std::clamp(P.subdivision_level, 1, kW2MaxSlots);
+        out.subdivision_level = level;
+        out.offset_step = P.offset_step;
+        out.rebounds_capacity = level - 1;
+        out.slots.resize(level);
+
+        const double support = std::max(0.0, P.support_time);
+        const double corpse = P.corpse_time;
+        W2Slot* s = out.slots.begin();
+        for (int k = 0; k < level; ++k) {
+            const double atten = 1.0 / (1.0 + support * (double)k);
+            s[k].index = k;
+            s[k].subdivision = level - k;
+            s[k].offset = (double)k * P.offset_step;
+            s[k].life = std::max(0.0, corpse * atten);
+        }
+        return out;
+    }
+
+} // namespace t2d